@@ -1,8 +1,7 @@
 #include "ExprParser.hpp"
 
+#include <charconv>
 #include <iostream>
-#include <spanstream>
-#include <stack>
 
 import parsec;
 
@@ -10,57 +9,57 @@ class ExprEvaluator : Parser {
 public:
 
     explicit ExprEvaluator(std::string_view expr)
-        : Parser(&expr_), expr_(expr) {}
+        : Parser(expr) {}
 
     double eval() {
         parse();
-
-        const auto result = evalStack_.top();
-        evalStack_.pop();
-        return result;
+        return result_;
     }
 
 private:
-    void onFactor(std::span<const Token> tokens) override {
-        if(tokens.front().kind() == TokenKinds::Number) {
-            evalStack_.push(std::stod(tokens.front().text()));
-        }
+    void onRootExpr(std::span<const Token> tokens, std::span<SemanticValue> values) override {
+        result_ = valueOf<ParseRules::Expr>(values.front());
     }
 
-    void onExpr(std::span<const Token> tokens) override {
-        if(tokens.size() == 1) {
-            evalBinary(tokens.front().kind());
+    double onExpr(std::span<const Token> tokens, std::span<SemanticValue> values) override {
+        if(tokens.empty()) {
+            return valueOf<ParseRules::Term>(values.front());
         }
+        return evalBinary(valueOf<ParseRules::Expr>(values[0]), tokens.front().kind(), valueOf<ParseRules::Term>(values[1]));
     }
 
-    void onTerm(std::span<const Token> tokens) override {
-        if(tokens.size() == 1) {
-            evalBinary(tokens.front().kind());
+    double onTerm(std::span<const Token> tokens, std::span<SemanticValue> values) override {
+        if(tokens.empty()) {
+            return valueOf<ParseRules::Factor>(values.front());
         }
+        return evalBinary(valueOf<ParseRules::Term>(values[0]), tokens.front().kind(), valueOf<ParseRules::Factor>(values[1]));
     }
 
+    double onFactor(std::span<const Token> tokens, std::span<SemanticValue> values) override {
+        if(tokens.front().kind() != TokenKinds::Number) {
+            return valueOf<ParseRules::Expr>(values.front());
+        }
 
-    void evalBinary(TokenKinds op) {
-        const double rhs = evalStack_.top();
-        evalStack_.pop();
+        const auto text = tokens.front().text();
+
+        double value = 0;
+        std::from_chars(text.data(), text.data() + text.size(), value);
+        return value;
+    }
 
-        const double lhs = evalStack_.top();
-        evalStack_.pop();
 
-        double result = 0;
+    static double evalBinary(double lhs, TokenKinds op, double rhs) {
         switch(op) {
-            case TokenKinds::AddOp: result = lhs + rhs; break;
-            case TokenKinds::SubOp: result = lhs - rhs; break;
-            case TokenKinds::MulOp: result = lhs * rhs; break;
-            case TokenKinds::DivOp: result = lhs / rhs; break;
-            default:                break;
+            case TokenKinds::AddOp: return lhs + rhs;
+            case TokenKinds::SubOp: return lhs - rhs;
+            case TokenKinds::MulOp: return lhs * rhs;
+            case TokenKinds::DivOp: return lhs / rhs;
+            default:                return 0;
         }
-        evalStack_.push(result);
     }
 
 
-    std::stack<double> evalStack_;
-    std::ispanstream expr_;
+    double result_ = 0;
 };
 
 int main(int argc, const char* argv[]) {
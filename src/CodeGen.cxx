@@ -1,7 +1,24 @@
 module;
 
 #include <inja/inja.hpp>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <format>
+#include <functional>
 #include <iterator>
+#include <limits>
+#include <map>
+#include <numeric>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 module parsec;
 
@@ -11,94 +28,885 @@ import parsec.bnf;
 
 namespace parsec {
     namespace {
+        constexpr int ByteCount = 256;
+
+        // self-loops on bytes spread over more ranges than this are not worth scanning with vector instructions
+        constexpr int MaxSelfLoopRanges = 4;
+
+        // how many seeds to try for a perfect hash of keywords before making the hash table larger
+        constexpr std::uint64_t MaxKeywordSeeds = 1 << 12;
+
+        // how much JSON output to accumulate before passing it on to the output stream
+        constexpr std::size_t JsonBufferSize = 1 << 16;
+
+        constexpr int JsonIndent = 4;
+
+
+        /**
+         * @brief Writes a JSON document piece by piece in the same layout as inja::json::dump(JsonIndent), without holding all of it in memory.
+         */
+        class JsonWriter {
+        public:
+
+            explicit JsonWriter(std::ostream* output)
+                : output_(output) {}
+
+
+            void beginObject() {
+                beginValue();
+                buffer_ += '{';
+                elementCounts_.push_back(0);
+            }
+
+            void endObject() {
+                endContainer('}');
+            }
+
+            void beginArray() {
+                beginValue();
+                buffer_ += '[';
+                elementCounts_.push_back(0);
+            }
+
+            void endArray() {
+                endContainer(']');
+            }
+
+
+            void key(std::string_view name) {
+                beginElement();
+                buffer_ += '"';
+                buffer_ += name;
+                buffer_ += "\": ";
+                afterKey_ = true;
+            }
+
+            void value(int value) {
+                beginValue();
+                buffer_ += std::to_string(value);
+            }
+
+            void value(const inja::json& value) {
+                beginValue();
+
+                // the value is dumped as if it was the whole document, so its lines have to be shifted to the current depth
+                const auto indent = std::string(elementCounts_.size() * JsonIndent, ' ');
+                for(const auto ch : value.dump(JsonIndent)) {
+                    buffer_ += ch;
+                    if(ch == '\n') {
+                        buffer_ += indent;
+                    }
+                }
+                flushIfFull();
+            }
+
+
+            void flush() {
+                output_->write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+                buffer_.clear();
+            }
+
+        private:
+            void beginValue() {
+                if(afterKey_) {
+                    afterKey_ = false;
+                } else if(!elementCounts_.empty()) {
+                    beginElement();
+                }
+            }
+
+            void beginElement() {
+                if(elementCounts_.back()++ > 0) {
+                    buffer_ += ',';
+                }
+                buffer_ += '\n';
+                buffer_.append(elementCounts_.size() * JsonIndent, ' ');
+            }
+
+            void endContainer(char bracket) {
+                const auto elementCount = elementCounts_.back();
+                elementCounts_.pop_back();
+
+                // empty containers are closed on the same line
+                if(elementCount > 0) {
+                    buffer_ += '\n';
+                    buffer_.append(elementCounts_.size() * JsonIndent, ' ');
+                }
+                buffer_ += bracket;
+                flushIfFull();
+            }
+
+            void flushIfFull() {
+                if(buffer_.size() >= JsonBufferSize) {
+                    flush();
+                }
+            }
+
+
+            std::string buffer_;
+            std::vector<int> elementCounts_;
+            bool afterKey_ = false;
+
+            std::ostream* output_ = {};
+        };
+
+
+        std::string escapeStringLiteral(std::string_view str) {
+            // a hexadecimal escape or a short octal one would take in a digit that follows it, full octal escapes end on their own
+            std::string escaped;
+            for(const auto ch : str) {
+                if(const auto chEscaped = text::escape(ch); chEscaped.starts_with("\\x") || chEscaped == "\\0") {
+                    escaped += std::format("\\{:03o}", static_cast<unsigned char>(ch));
+                } else {
+                    escaped += chEscaped;
+                }
+            }
+            return escaped;
+        }
+
+
         class GenerateJsonLexStates : private fsm::DfaStateGen::StateSink {
         public:
 
-            inja::json run(const bnf::SymbolGrammar* tokens) {
-                states_ = inja::json::array();
+            void run(const bnf::SymbolGrammar* tokens, int threadCount) {
+                stateTables_.clear();
+                stateTransitions_.clear();
 
+                minimizer_.setStateSink(this);
                 fsm::DfaStateGen()
-                    .setStateSink(this)
+                    .setStateSink(&minimizer_)
                     .setInputGrammar(tokens)
+                    .setThreadCount(threadCount)
                     .generate();
+                minimizer_.flush();
 
-                return std::move(states_);
+                addClassTransitions();
+                addSelfLoops();
+                addLiteralChains();
+            }
+
+            inja::json states() const {
+                auto states = inja::json::array();
+                for(int id = 0; const auto& state : stateTables_) {
+                    auto transitions = inja::json::array();
+                    for(const auto& [label, target] : state.transitions) {
+                        transitions.push_back({
+                            {  "label", text::escape(label.text()) },
+                            { "target",                     target }
+                        });
+                    }
+
+                    auto rangeTransitions = inja::json::array();
+                    for(const auto& range : state.rangeTransitions) {
+                        rangeTransitions.push_back({
+                            {  "first",  range.first },
+                            {   "last",   range.last },
+                            { "target", range.target }
+                        });
+                    }
+
+                    auto& json = states.emplace_back(inja::json {
+                        {                "id",                     id++ },
+                        {       "transitions",   std::move(transitions) },
+                        { "range_transitions", std::move(rangeTransitions) },
+                        {     "class_targets",       state.classTargets },
+                    });
+                    if(state.match) {
+                        json["match"] = state.match.text();
+                    }
+
+                    if(!state.selfLoop.empty()) {
+                        auto& selfLoop = json["self_loop"] = inja::json::array();
+                        for(const auto& [first, last] : state.selfLoop) {
+                            selfLoop.push_back({
+                                { "first", first },
+                                {  "last",  last }
+                            });
+                        }
+                    }
+
+                    if(state.literalChain) {
+                        json["literal_chain"] = {
+                            { "literal", escapeStringLiteral(state.literalChain->literal) },
+                            {  "length",              state.literalChain->literal.size() },
+                            {  "target",                       state.literalChain->target }
+                        };
+                    }
+
+                    if(state.chained) {
+                        json["chained"] = true;
+                    }
+                }
+                return states;
+            }
+
+            void writeStates(JsonWriter& json) const {
+                // same document as states() returns, written out state by state with the keys in their sorted order
+                json.beginArray();
+                for(int id = 0; const auto& state : stateTables_) {
+                    json.beginObject();
+                    if(state.chained) {
+                        json.key("chained");
+                        json.value(inja::json(true));
+                    }
+
+                    json.key("class_targets");
+                    json.beginArray();
+                    for(const auto target : state.classTargets) {
+                        json.value(target);
+                    }
+                    json.endArray();
+
+                    json.key("id");
+                    json.value(id++);
+
+                    if(state.literalChain) {
+                        json.key("literal_chain");
+                        json.beginObject();
+                        json.key("length");
+                        json.value(static_cast<int>(state.literalChain->literal.size()));
+                        json.key("literal");
+                        json.value(escapeStringLiteral(state.literalChain->literal));
+                        json.key("target");
+                        json.value(state.literalChain->target);
+                        json.endObject();
+                    }
+
+                    if(state.match) {
+                        json.key("match");
+                        json.value(state.match.text());
+                    }
+
+                    json.key("range_transitions");
+                    json.beginArray();
+                    for(const auto& range : state.rangeTransitions) {
+                        json.beginObject();
+                        json.key("first");
+                        json.value(range.first);
+                        json.key("last");
+                        json.value(range.last);
+                        json.key("target");
+                        json.value(range.target);
+                        json.endObject();
+                    }
+                    json.endArray();
+
+                    if(!state.selfLoop.empty()) {
+                        json.key("self_loop");
+                        json.beginArray();
+                        for(const auto& [first, last] : state.selfLoop) {
+                            json.beginObject();
+                            json.key("first");
+                            json.value(first);
+                            json.key("last");
+                            json.value(last);
+                            json.endObject();
+                        }
+                        json.endArray();
+                    }
+
+                    json.key("transitions");
+                    json.beginArray();
+                    for(const auto& [label, target] : state.transitions) {
+                        json.beginObject();
+                        json.key("label");
+                        json.value(text::escape(label.text()));
+                        json.key("target");
+                        json.value(target);
+                        json.endObject();
+                    }
+                    json.endArray();
+                    json.endObject();
+                }
+                json.endArray();
+            }
+
+            const std::array<int, ByteCount>& byteClasses() const noexcept {
+                return byteClasses_;
+            }
+
+            int byteClassCount() const noexcept {
+                return byteClassCount_;
+            }
+
+            const fsm::DfaMinimizer& minimizer() const noexcept {
+                return minimizer_;
             }
 
         private:
-            void addState(int id) override {
-                states_.push_back({
-                    {          "id",                  id },
-                    { "transitions", inja::json::array() },
-                });
+            /**
+             * @brief Range of consecutive bytes leading to the same state.
+             */
+            struct RangeTransition {
+                int first = {};
+                int last = {};
+                int target = {};
+            };
+
+            /**
+             * @brief Chain of states matched at once as a literal, ending in the target state.
+             */
+            struct LiteralChain {
+                std::string literal;
+                int target = {};
+            };
+
+            /**
+             * @brief Token state with everything the lexer backends need to know about it.
+             */
+            struct StateTable {
+                std::vector<std::pair<bnf::Symbol, int>> transitions;
+                std::vector<RangeTransition> rangeTransitions;
+                std::vector<int> classTargets;
+                std::vector<std::pair<int, int>> selfLoop;
+                std::optional<LiteralChain> literalChain;
+                bnf::Symbol match;
+                bool chained = false;
+            };
+
+
+            void addState(int /*id*/) override {
+                stateTables_.emplace_back();
+                stateTransitions_.emplace_back();
             }
 
             void addStateTransition(int state, int target, const bnf::Symbol& label) override {
-                states_[state]["transitions"].push_back({
-                    {  "label", text::escape(label.text()) },
-                    { "target",                     target }
-                });
+                stateTables_[state].transitions.emplace_back(label, target);
+                stateTransitions_[state].emplace_back(text::toInt(label.text().front()), target);
+            }
+
+            void addStateRangeTransition(int state, int target, int first, int last) override {
+                stateTables_[state].rangeTransitions.push_back({ .first = first, .last = last, .target = target });
+                for(int byte = first; byte <= last; byte++) {
+                    stateTransitions_[state].emplace_back(byte, target);
+                }
             }
 
             void setStateMatch(int state, const bnf::Symbol& match) override {
-                states_[state]["match"] = match.text();
+                stateTables_[state].match = match;
+            }
+
+            void addClassTransitions() {
+                computeByteClasses();
+
+                // describe transitions of each state in terms of byte classes rather than individual bytes
+                for(std::size_t state = 0; state < stateTransitions_.size(); state++) {
+                    auto classTargets = std::vector<int>(byteClassCount_, -1);
+                    for(const auto& [byte, target] : stateTransitions_[state]) {
+                        classTargets[byteClasses_[byte]] = target;
+                    }
+                    stateTables_[state].classTargets = std::move(classTargets);
+                }
+            }
+
+            void addSelfLoops() {
+                // a state looping on itself consumes whole runs of bytes, describe them as ranges of byte values
+                for(std::size_t state = 0; state < stateTransitions_.size(); state++) {
+                    auto loopBytes = std::vector<int>();
+                    for(const auto& [byte, target] : stateTransitions_[state]) {
+                        if(target == static_cast<int>(state)) {
+                            loopBytes.push_back(byte);
+                        }
+                    }
+                    std::ranges::sort(loopBytes);
+
+                    auto ranges = std::vector<std::pair<int, int>>();
+                    for(std::size_t i = 0; i < loopBytes.size(); i++) {
+                        if(i == 0 || loopBytes[i] != loopBytes[i - 1] + 1) {
+                            ranges.emplace_back(loopBytes[i], loopBytes[i]);
+                        } else {
+                            ranges.back().second = loopBytes[i];
+                        }
+                    }
+
+                    if(ranges.size() <= MaxSelfLoopRanges) {
+                        stateTables_[state].selfLoop = std::move(ranges);
+                    }
+                }
+            }
+
+            void addLiteralChains() {
+                auto predecessorCounts = std::vector<int>(stateTransitions_.size());
+                for(const auto& transitions : stateTransitions_) {
+                    for(const auto& [byte, target] : transitions) {
+                        predecessorCounts[target]++;
+                    }
+                }
+
+                // a link of a chain is only ever entered from the previous link and can only go on to the next one
+                const auto isChainLink = [this, &predecessorCounts](int state) {
+                    return state != 0 && predecessorCounts[state] == 1 && stateTransitions_[state].size() == 1
+                        && !stateTables_[state].match && isChainByte(stateTransitions_[state].front().first);
+                };
+
+                for(std::size_t state = 0; state < stateTransitions_.size(); state++) {
+                    if(stateTransitions_[state].size() != 1 || !isChainByte(stateTransitions_[state].front().first)) {
+                        continue;
+                    }
+
+                    auto [byte, target] = stateTransitions_[state].front();
+                    auto literal = std::string(1, static_cast<char>(byte));
+                    auto links = std::vector<int>();
+                    while(target != static_cast<int>(state) && isChainLink(target)) {
+                        links.push_back(target);
+                        literal += static_cast<char>(stateTransitions_[target].front().first);
+                        target = stateTransitions_[target].front().second;
+                    }
+
+                    if(links.empty() || target == static_cast<int>(state)) {
+                        continue;
+                    }
+
+                    // the whole chain is matched at once, so its links need no code of their own
+                    stateTables_[state].literalChain = LiteralChain { .literal = std::move(literal), .target = target };
+                    for(const auto link : links) {
+                        stateTables_[link].chained = true;
+                    }
+                }
+            }
+
+            static bool isChainByte(int byte) {
+                // newlines would require updating the line information, unprintable bytes escaping
+                return byte != '\n' && text::isPrint(static_cast<char>(byte));
             }
 
-            inja::json states_;
+            void computeByteClasses() {
+                byteClasses_.fill(0);
+                byteClassCount_ = 1;
+
+                // two bytes are equivalent if every state has the same transition on both of them
+                auto byteTargets = std::array<int, ByteCount>();
+                for(const auto& transitions : stateTransitions_) {
+                    byteTargets.fill(-1);
+                    for(const auto& [byte, target] : transitions) {
+                        byteTargets[byte] = target;
+                    }
+
+                    std::map<std::pair<int, int>, int> refinedClasses;
+                    for(int byte = 0; byte < ByteCount; byte++) {
+                        const auto classId = static_cast<int>(refinedClasses.size());
+                        const auto [it, ok] = refinedClasses.try_emplace({ byteClasses_[byte], byteTargets[byte] }, classId);
+                        byteClasses_[byte] = it->second;
+                    }
+                    byteClassCount_ = static_cast<int>(refinedClasses.size());
+                }
+            }
+
+            std::vector<std::vector<std::pair<int, int>>> stateTransitions_;
+            std::array<int, ByteCount> byteClasses_ = {};
+            int byteClassCount_ = 1;
+
+            std::vector<StateTable> stateTables_;
+            fsm::DfaMinimizer minimizer_;
         };
 
 
+        /**
+         * @brief Sparse table rows packed into a single vector so that they overlap without colliding.
+         */
+        struct PackedTable {
+            std::vector<int> base;
+            std::vector<int> check;
+            std::vector<int> next;
+        };
+
+
+        PackedTable packTableRows(const std::vector<std::vector<std::pair<int, int>>>& rows, int columnCount) {
+            // rows with more entries are harder to fit, so they are placed first
+            auto order = std::vector<int>(rows.size());
+            std::iota(order.begin(), order.end(), 0);
+            std::ranges::stable_sort(order, std::ranges::greater(), [&rows](int row) { return rows[row].size(); });
+
+            PackedTable table;
+            table.base.assign(rows.size(), 0);
+
+            // every used cell points towards a following cell that may be free, so runs of used cells are skipped at once
+            std::vector<int> nextFree;
+            const auto findFree = [&nextFree](int index) {
+                auto free = index;
+                while(free < static_cast<int>(nextFree.size()) && nextFree[free] != free) {
+                    free = nextFree[free];
+                }
+                while(index != free) {
+                    index = std::exchange(nextFree[index], free);
+                }
+                return free;
+            };
+
+            for(const auto row : order) {
+                const auto& entries = rows[row];
+                if(entries.empty()) {
+                    continue;
+                }
+
+                const auto isFree = [&table](int index) {
+                    return index >= static_cast<int>(table.check.size()) || table.check[index] == -1;
+                };
+
+                // find the lowest displacement at which all entries of the row fall into unused cells,
+                // only trying those that put the first entry into a free cell
+                const auto firstColumn = entries.front().first;
+                auto base = findFree(firstColumn) - firstColumn;
+                while(!std::ranges::all_of(entries, [&](const auto& entry) { return isFree(base + entry.first); })) {
+                    base = findFree(base + firstColumn + 1) - firstColumn;
+                }
+
+                table.base[row] = base;
+                for(const auto& [column, value] : entries) {
+                    if(base + column >= static_cast<int>(table.check.size())) {
+                        const auto oldSize = static_cast<int>(table.check.size());
+                        table.check.resize(base + column + 1, -1);
+                        table.next.resize(base + column + 1, -1);
+
+                        nextFree.resize(base + column + 1);
+                        std::iota(nextFree.begin() + oldSize, nextFree.end(), oldSize);
+                    }
+                    table.check[base + column] = row;
+                    table.next[base + column] = value;
+                    nextFree[base + column] = base + column + 1;
+                }
+            }
+
+            // make sure that a lookup of any column in any row stays within the table
+            const auto size = (table.base.empty() ? 0 : std::ranges::max(table.base)) + columnCount;
+            if(size > static_cast<int>(table.check.size())) {
+                table.check.resize(size, -1);
+                table.next.resize(size, -1);
+            }
+            return table;
+        }
+
+
+        /**
+         * @brief Literal token recognized by looking up the text of another token that matches it too.
+         */
+        struct Keyword {
+            bnf::Symbol name;
+            std::string text;
+        };
+
+
+        bnf::SymbolGrammar extractKeywords(const bnf::SymbolGrammar* tokens, std::map<bnf::Symbol, std::vector<Keyword>>& keywords) {
+            bnf::SymbolGrammar remaining;
+            if(!tokens) {
+                return remaining;
+            }
+
+            // a literal is only looked up if a token of another kind matches it, usually an identifier
+            const auto findMatchingToken = [tokens](const bnf::Symbol& literal, std::string_view text) -> const bnf::Symbol* {
+                const bnf::Symbol* match = nullptr;
+                for(const auto& symbol : tokens->symbols()) {
+                    const auto* const rule = tokens->resolve(symbol);
+                    if(symbol == literal || !rule || rule->literal() || !rule->matches(text)) {
+                        continue;
+                    }
+
+                    // the literal could be looked up after either of the tokens, so neither is picked
+                    if(match) {
+                        throw fsm::NameConflictError(*match, symbol);
+                    }
+                    match = &symbol;
+                }
+                return match;
+            };
+
+            for(const auto& symbol : tokens->symbols()) {
+                const auto* const rule = tokens->resolve(symbol);
+                if(!rule) {
+                    remaining.define(symbol);
+                    continue;
+                }
+
+                if(auto text = rule->literal(); text && !text->empty()) {
+                    if(const auto* const token = findMatchingToken(symbol, *text)) {
+                        keywords[*token].push_back({ .name = symbol, .text = std::move(*text) });
+                        continue;
+                    }
+                }
+                remaining.define(symbol, *rule);
+            }
+            return remaining;
+        }
+
+
+        std::uint64_t hashKeyword(std::string_view text, std::uint64_t seed) {
+            // has to match the hash function of the generated lexer
+            auto hash = seed ^ 0xcbf29ce484222325;
+            for(const auto ch : text) {
+                hash = (hash ^ static_cast<unsigned char>(ch)) * 0x100000001b3;
+            }
+            return hash * 0x9e3779b97f4a7c15;
+        }
+
+
+        inja::json generateJsonKeywordTable(const bnf::Symbol& token, const std::vector<Keyword>& keywords) {
+            // keep the table at most half full, so that a seed without collisions is quick to find
+            auto bits = std::max(static_cast<int>(std::bit_width(2 * keywords.size() - 1)), 1);
+            auto slots = std::vector<int>();
+            while(true) {
+                const auto shift = 64 - bits;
+                for(std::uint64_t seed = 0; seed < MaxKeywordSeeds; seed++) {
+                    slots.assign(std::size_t(1) << bits, -1);
+
+                    bool isPerfect = true;
+                    for(std::size_t i = 0; i < keywords.size() && isPerfect; i++) {
+                        auto& slot = slots[hashKeyword(keywords[i].text, seed) >> shift];
+                        isPerfect = slot == -1;
+                        slot = static_cast<int>(i);
+                    }
+
+                    if(isPerfect) {
+                        // empty slots map to the token itself, with an empty text that never matches
+                        auto slotsJson = inja::json::array();
+                        for(const auto slot : slots) {
+                            slotsJson.push_back({
+                                { "text", slot != -1 ? escapeStringLiteral(keywords[slot].text) : "" },
+                                { "name", slot != -1 ? keywords[slot].name.text() : token.text() }
+                            });
+                        }
+
+                        return {
+                            {  "seed",                seed },
+                            { "shift",               shift },
+                            { "slots", std::move(slotsJson) }
+                        };
+                    }
+                }
+                bits++;
+            }
+        }
+
+
+        inja::json generateJsonKeywords(const std::map<bnf::Symbol, std::vector<Keyword>>& keywords) {
+            auto json = inja::json::array();
+            for(const auto& [token, group] : keywords) {
+                auto table = generateJsonKeywordTable(token, group);
+                table["token"] = token.text();
+                json.push_back(std::move(table));
+            }
+            return json;
+        }
+
+
+        std::unordered_map<bnf::Symbol, int> indexSortedSymbols(const bnf::SymbolGrammar* grammar) {
+            // generated enumerations list the symbols in the sorted order
+            std::vector<bnf::Symbol> symbols;
+            if(grammar) {
+                symbols.assign(grammar->symbols().begin(), grammar->symbols().end());
+            }
+            std::ranges::sort(symbols, {}, &bnf::Symbol::text);
+
+            std::unordered_map<bnf::Symbol, int> indices;
+            for(const auto& symbol : symbols) {
+                indices.try_emplace(symbol, static_cast<int>(indices.size()));
+            }
+            return indices;
+        }
+
+
         class GenerateJsonParseStates : private fsm::ElrStateGen::StateSink {
         public:
 
-            inja::json run(const bnf::SymbolGrammar* rules) {
-                states_ = inja::json::array();
+            void run(const bnf::SymbolGrammar* rules, int threadCount) {
+                stateTables_.clear();
 
-                fsm::ElrStateGen()
+                stateGen_
                     .setStateSink(this)
                     .setInputGrammar(rules)
+                    .setThreadCount(threadCount)
                     .generate();
+            }
+
+            inja::json states() const {
+                auto states = inja::json::array();
+                for(int id = 0; const auto& state : stateTables_) {
+                    auto& json = states.emplace_back(inja::json {
+                        {                "id",                                   id++ },
+                        { "token_transitions", generateJsonTransitions(state.tokenTransitions) },
+                        {  "rule_transitions",  generateJsonTransitions(state.ruleTransitions) },
+                        {         "backlinks",                        state.backlinks },
+                    });
+                    if(state.match) {
+                        json["match"] = state.match.text();
+                        json["active_backlink"] = state.activeBacklink;
+                    }
+                }
+                return states;
+            }
+
+            void writeStates(JsonWriter& json) const {
+                // same document as states() returns, written out state by state with the keys in their sorted order
+                json.beginArray();
+                for(int id = 0; const auto& state : stateTables_) {
+                    json.beginObject();
+                    if(state.match) {
+                        json.key("active_backlink");
+                        json.value(state.activeBacklink);
+                    }
+
+                    json.key("backlinks");
+                    json.beginArray();
+                    for(const auto backlink : state.backlinks) {
+                        json.value(backlink);
+                    }
+                    json.endArray();
+
+                    json.key("id");
+                    json.value(id++);
+
+                    if(state.match) {
+                        json.key("match");
+                        json.value(state.match.text());
+                    }
+
+                    json.key("rule_transitions");
+                    writeTransitions(json, state.ruleTransitions);
+                    json.key("token_transitions");
+                    writeTransitions(json, state.tokenTransitions);
+                    json.endObject();
+                }
+                json.endArray();
+            }
+
+            const fsm::ElrStateGen& stateGen() const noexcept {
+                return stateGen_;
+            }
+
+            int stateCount() const noexcept {
+                return static_cast<int>(stateTables_.size());
+            }
+
+            inja::json tables(const bnf::SymbolGrammar* tokens, const bnf::SymbolGrammar* rules) const {
+                const auto tokenIndices = indexSortedSymbols(tokens);
+                const auto ruleIndices = indexSortedSymbols(rules);
+
+                std::vector<std::vector<std::pair<int, int>>> shiftRows;
+                std::vector<std::vector<std::pair<int, int>>> gotoRows;
+                std::vector<int> matches;
+                std::vector<int> activeBacklinks;
+                std::vector<int> backlinkOffsets;
+                std::vector<int> backlinks;
+
+                for(const auto& state : stateTables_) {
+                    auto& shiftRow = shiftRows.emplace_back();
+                    for(const auto& [label, target] : state.tokenTransitions) {
+                        shiftRow.emplace_back(tokenIndices.at(label), target);
+                    }
+                    std::ranges::sort(shiftRow);
+
+                    auto& gotoRow = gotoRows.emplace_back();
+                    for(const auto& [label, target] : state.ruleTransitions) {
+                        gotoRow.emplace_back(ruleIndices.at(label), target);
+                    }
+                    std::ranges::sort(gotoRow);
+
+                    matches.push_back(state.match ? ruleIndices.at(state.match) : -1);
+                    activeBacklinks.push_back(state.activeBacklink);
+
+                    backlinkOffsets.push_back(static_cast<int>(backlinks.size()));
+                    backlinks.insert(backlinks.end(), state.backlinks.begin(), state.backlinks.end());
+                }
+
+                const auto shiftTable = packTableRows(shiftRows, static_cast<int>(tokenIndices.size()));
+                const auto gotoTable = packTableRows(gotoRows, static_cast<int>(ruleIndices.size()));
 
-                return std::move(states_);
+                // use the narrowest integer type able to hold all of the table values
+                const auto fitsInt16 = [](const std::vector<int>& values) {
+                    return std::ranges::all_of(values, [](int value) {
+                        return value >= std::numeric_limits<std::int16_t>::min() && value <= std::numeric_limits<std::int16_t>::max();
+                    });
+                };
+
+                const auto intType = fitsInt16(shiftTable.next) && fitsInt16(shiftTable.base) && fitsInt16(shiftTable.check)
+                                      && fitsInt16(gotoTable.next) && fitsInt16(gotoTable.base) && fitsInt16(gotoTable.check)
+                                      && fitsInt16(backlinkOffsets) && fitsInt16(backlinks)
+                                   ? "std::int16_t"
+                                   : "std::int32_t";
+                const auto table = [](std::string_view name, std::string_view type, const std::vector<int>& values) {
+                    return inja::json {
+                        {    "name",   name },
+                        {    "type",   type },
+                        { "entries", values }
+                    };
+                };
+
+                return {
+                    table("ShiftBase", intType, shiftTable.base),
+                    table("ShiftCheck", intType, shiftTable.check),
+                    table("ShiftNext", intType, shiftTable.next),
+                    table("GotoBase", intType, gotoTable.base),
+                    table("GotoCheck", intType, gotoTable.check),
+                    table("GotoNext", intType, gotoTable.next),
+                    table("Matches", "int", matches),
+                    table("ActiveBacklinks", "int", activeBacklinks),
+                    table("BacklinkOffsets", intType, backlinkOffsets),
+                    table("Backlinks", intType, backlinks)
+                };
             }
 
         private:
-            void addState(int id) override {
-                states_.push_back({
-                    {                "id",                  id },
-                    { "token_transitions", inja::json::array() },
-                    {  "rule_transitions", inja::json::array() },
-                    {         "backlinks", inja::json::array() },
-                });
+            static inja::json generateJsonTransitions(const std::vector<std::pair<bnf::Symbol, int>>& transitions) {
+                auto json = inja::json::array();
+                for(const auto& [label, target] : transitions) {
+                    json.push_back({
+                        {  "label", text::escape(label.text()) },
+                        { "target",                     target }
+                    });
+                }
+                return json;
+            }
+
+            static void writeTransitions(JsonWriter& json, const std::vector<std::pair<bnf::Symbol, int>>& transitions) {
+                json.beginArray();
+                for(const auto& [label, target] : transitions) {
+                    json.beginObject();
+                    json.key("label");
+                    json.value(text::escape(label.text()));
+                    json.key("target");
+                    json.value(target);
+                    json.endObject();
+                }
+                json.endArray();
+            }
+
+
+            void addState(int /*id*/) override {
+                stateTables_.emplace_back();
             }
 
             void addStateTokenTransition(int state, int target, const bnf::Symbol& label) override {
-                states_[state]["token_transitions"].push_back({
-                    {  "label", text::escape(label.text()) },
-                    { "target",                     target }
-                });
+                stateTables_[state].tokenTransitions.emplace_back(label, target);
             }
 
             void addStateRuleTransition(int state, int target, const bnf::Symbol& label) override {
-                states_[state]["rule_transitions"].push_back({
-                    {  "label", text::escape(label.text()) },
-                    { "target",                     target }
-                });
+                stateTables_[state].ruleTransitions.emplace_back(label, target);
             }
 
             void addStateBacklink(int state, int backlink) override {
-                states_[state]["backlinks"].push_back(backlink);
+                stateTables_[state].backlinks.push_back(backlink);
             }
 
             void setActiveBacklink(int state, int backlink) override {
-                states_[state]["active_backlink"] = backlink;
+                stateTables_[state].activeBacklink = backlink;
             }
 
             void setStateMatch(int state, const bnf::Symbol& match) override {
-                states_[state]["match"] = match.text();
+                stateTables_[state].match = match;
             }
 
-            inja::json states_;
+            /**
+             * @brief Parse state as seen by the table-driven parser.
+             */
+            struct StateTable {
+                std::vector<std::pair<bnf::Symbol, int>> tokenTransitions;
+                std::vector<std::pair<bnf::Symbol, int>> ruleTransitions;
+                std::vector<int> backlinks;
+                bnf::Symbol match;
+                int activeBacklink = -1;
+            };
+
+            std::vector<StateTable> stateTables_;
+            fsm::ElrStateGen stateGen_;
         };
 
 
@@ -111,6 +919,24 @@ namespace parsec {
             }
             return json;
         }
+
+
+        bool usesParseTables(const std::map<std::string, std::string>& options) {
+            // the packed tables are only read by the table-driven parser, which push input always selects
+            const auto option = [&options](const std::string& name) {
+                const auto it = options.find(name);
+                return it != options.end() ? std::string_view(it->second) : std::string_view();
+            };
+            return option("parser_backend") == "table" || option("lexer_input") == "push";
+        }
+
+
+        bool usesSemanticValues(const std::map<std::string, std::string>& options) {
+            // the value stack is only kept once a rule declares the type of its value
+            return std::ranges::any_of(options, [](const auto& option) {
+                return option.first.starts_with("value_type.");
+            });
+        }
     }
 
 
@@ -119,22 +945,88 @@ namespace parsec {
             return;
         }
 
-        const inja::json vars = {
-            {      "token_names",          generateJsonSymbols(tokens_) },
-            {       "lex_states",  GenerateJsonLexStates().run(tokens_) },
-            { "parse_rule_names",           generateJsonSymbols(rules_) },
-            {     "parse_states", GenerateJsonParseStates().run(rules_) }
-        };
+        // keywords are left out of the lexer automaton, they are looked up once a token matching them is recognized
+        std::map<bnf::Symbol, std::vector<Keyword>> keywords;
+        const auto lexTokens = extractKeywords(tokens_, keywords);
+
+        GenerateJsonLexStates lexStates;
+        lexStates.run(&lexTokens, threadCount_);
 
-        if(tmpl_) {
-            const auto tmplStr = std::string(
-                std::istreambuf_iterator<char>(*tmpl_),
-                std::istreambuf_iterator<char>()
+        GenerateJsonParseStates parseStates;
+        parseStates.run(rules_, threadCount_);
+        const auto parseTables = usesParseTables(templateOptions_);
+        const auto semanticValues = usesSemanticValues(templateOptions_);
+
+        if(log_) {
+            *log_ << std::format(
+                "token DFA states: {} ({} before minimization)\n"
+                "rule DFA states: {} ({} before minimization)\n",
+                lexStates.minimizer().outputStateCount(),
+                lexStates.minimizer().inputStateCount(),
+                parseStates.stateGen().dfaOutputStateCount(),
+                parseStates.stateGen().dfaInputStateCount()
             );
 
-            inja::render_to(*output_, tmplStr, vars);
+            for(const auto& [token, group] : keywords) {
+                *log_ << std::format("keywords looked up for {}: {}\n", token.text(), group.size());
+            }
+        }
+
+        if(!tmpl_) {
+            // without a template, the parser states are written out directly instead of being gathered into a document first
+            JsonWriter json(output_);
+            json.beginObject();
+            json.key("lex_byte_classes");
+            json.value(lexStates.byteClasses());
+            json.key("lex_class_count");
+            json.value(lexStates.byteClassCount());
+            json.key("lex_keywords");
+            json.value(generateJsonKeywords(keywords));
+            json.key("lex_states");
+            lexStates.writeStates(json);
+            json.key("options");
+            json.value(templateOptions_);
+            json.key("parse_rule_names");
+            json.value(generateJsonSymbols(rules_));
+            json.key("parse_state_count");
+            json.value(parseStates.stateCount());
+            json.key("parse_states");
+            parseStates.writeStates(json);
+            if(parseTables) {
+                json.key("parse_tables");
+                json.value(parseStates.tables(tokens_, rules_));
+            }
+            json.key("semantic_values");
+            json.value(inja::json(semanticValues));
+            json.key("token_names");
+            json.value(generateJsonSymbols(tokens_));
+            json.endObject();
+            json.flush();
+            return;
+        }
+
+        inja::json vars = {
+            {       "token_names",   generateJsonSymbols(tokens_) },
+            {        "lex_states",             lexStates.states() },
+            {  "lex_byte_classes",        lexStates.byteClasses() },
+            {   "lex_class_count",     lexStates.byteClassCount() },
+            {      "lex_keywords", generateJsonKeywords(keywords) },
+            {  "parse_rule_names",    generateJsonSymbols(rules_) },
+            { "parse_state_count",       parseStates.stateCount() },
+            {           "options",               templateOptions_ },
+            {   "semantic_values",                 semanticValues }
+        };
+        // the table backend only needs the packed tables, so the states are only spelled out for the recursive one
+        if(parseTables) {
+            vars["parse_tables"] = parseStates.tables(tokens_, rules_);
         } else {
-            *output_ << vars.dump(4);
+            vars["parse_states"] = parseStates.states();
         }
+
+        const auto tmplStr = std::string(
+            std::istreambuf_iterator<char>(*tmpl_),
+            std::istreambuf_iterator<char>()
+        );
+        inja::render_to(*output_, tmplStr, vars);
     }
 }
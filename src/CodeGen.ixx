@@ -1,7 +1,9 @@
 module;
 
 #include <istream>
+#include <map>
 #include <ostream>
+#include <string>
 
 export module parsec:CodeGen;
 
@@ -35,6 +37,14 @@ namespace parsec {
         }
 
 
+        /**
+         * @brief Set an output stream to receive statistics about the generated automata.
+         */
+        void setLogSink(std::ostream* log) {
+            log_ = log;
+        }
+
+
         /**
          * @brief Set an input stream to use as the source of a template for the generated code.
          */
@@ -59,6 +69,22 @@ namespace parsec {
         }
 
 
+        /**
+         * @brief Set a named option to make available to the template.
+         */
+        void setTemplateOption(const std::string& name, const std::string& value) {
+            templateOptions_[name] = value;
+        }
+
+
+        /**
+         * @brief Set the number of threads to generate the automata with.
+         */
+        void setThreadCount(int count) {
+            threadCount_ = count;
+        }
+
+
         /**
          * @brief Start the generation process.
          */
@@ -67,11 +93,16 @@ namespace parsec {
 
 
     private:
+        std::map<std::string, std::string> templateOptions_;
+
         const bnf::SymbolGrammar* tokens_ = {};
         const bnf::SymbolGrammar* rules_ = {};
 
         std::ostream* output_ = {};
+        std::ostream* log_ = {};
         std::istream* tmpl_ = {};
+
+        int threadCount_ = 1;
     };
 
 }
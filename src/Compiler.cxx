@@ -324,6 +324,10 @@ namespace parsec {
             return;
         }
 
+        // the symbols are not used once the code is generated, so they do not have to stay around for the next compilation
+        bnf::SymbolTable symbols(threadCount_ != 1);
+        const bnf::SymbolTable::Scope symbolScope(&symbols);
+
         PatternNameCache patterns;
         NameTable names;
 
@@ -2,6 +2,7 @@ module;
 
 #include <istream>
 #include <ostream>
+#include <string>
 
 export module parsec:Compiler;
 
@@ -43,6 +44,31 @@ namespace parsec {
         }
 
 
+        /**
+         * @brief Set an output stream to receive statistics about the generated automata.
+         */
+        void setLogSink(std::ostream* log) {
+            codegen_.setLogSink(log);
+        }
+
+
+        /**
+         * @brief Set a named option to make available to the output template.
+         */
+        void setTemplateOption(const std::string& name, const std::string& value) {
+            codegen_.setTemplateOption(name, value);
+        }
+
+
+        /**
+         * @brief Set the number of threads to generate the automata with.
+         */
+        void setThreadCount(int count) {
+            codegen_.setThreadCount(count);
+            threadCount_ = count;
+        }
+
+
         /**
          * @brief Set an input stream containing the grammar to compile.
          */
@@ -53,6 +79,7 @@ namespace parsec {
 
         /**
          * @brief Start the compilation process.
+         * @details The names of the symbols are interned into a table of the compilation's own, freed when it finishes.
          */
         void compile();
         /** @} */
@@ -60,6 +87,7 @@ namespace parsec {
 
     private:
         std::istream* input_ = {};
+        int threadCount_ = 1;
         CodeGen codegen_;
     };
 
@@ -2,6 +2,8 @@ module;
 
 #include <algorithm>
 #include <memory>
+#include <optional>
+#include <string>
 #include <string_view>
 #include <utility>
 #include <vector>
@@ -14,176 +16,194 @@ using namespace parsec::bnf;
 using namespace parsec::regex;
 
 namespace {
-    std::vector<int> computeFirstOrLastPos(const ExprNode& n, int nextAtomIndex, bool firstOrLast) {
-        class Impl : private NodeVisitor {
-        public:
-
-            Impl(int nextAtomIndex, bool firstOrLast)
-                : nextAtomIndex_(nextAtomIndex), firstOrLast_(firstOrLast) {}
-
-            std::vector<int> run(const ExprNode& n) {
-                n.accept(*this);
-                return std::move(indices_);
-            }
+    /**
+     * @brief Positional information about a regular expression, needed to convert it to DFA.
+     */
+    struct Positions {
+        std::vector<Symbol> symbols;
+        std::vector<std::optional<CharSet>> charSets;
 
-        private:
-            void visit(const AtomExprNode& n) override {
-                if(!n.isNull()) {
-                    // only non-empty atoms must have positional indices assigned
-                    indices_.push_back(nextAtomIndex_);
-                }
-            }
+        std::vector<int> followPosOffsets;
+        std::vector<int> followPos;
+        std::vector<int> firstPos;
+    };
 
-            void visit(const PlusClosureNode& n) override {
-                n.inner()->accept(*this);
-            }
-
-            void visit(const StarClosureNode& n) override {
-                n.inner()->accept(*this);
-            }
-
-            void visit(const OptionalExprNode& n) override {
-                n.inner()->accept(*this);
-            }
-
-            void visit(const AlternExprNode& n) override {
-                n.left()->accept(*this);
 
-                const auto leftSize = n.left()->atomCount();
-                nextAtomIndex_ += leftSize;
-                n.right()->accept(*this);
-                nextAtomIndex_ -= leftSize;
-            }
+    Positions computePositions(const ExprNode& n) {
+        class Impl : private NodeVisitor {
+        public:
 
-            void visit(const ConcatExprNode& n) override {
-                if(firstOrLast_ || n.right()->isNullable()) {
-                    n.left()->accept(*this);
-                }
+            Positions run(const ExprNode& n) {
+                auto root = visitNode(n);
 
-                if(!firstOrLast_ || n.left()->isNullable()) {
-                    const auto leftSize = n.left()->atomCount();
-                    nextAtomIndex_ += leftSize;
-                    n.right()->accept(*this);
-                    nextAtomIndex_ -= leftSize;
+                // the end of the expression is marked with an additional position past all the atoms
+                const auto endPos = static_cast<int>(positions_.symbols.size());
+                addFollowPos(root.lastPos, { endPos });
+                if(root.nullable) {
+                    root.firstPos.push_back(endPos);
                 }
-            }
 
-            std::vector<int> indices_;
-            int nextAtomIndex_ = {};
-            bool firstOrLast_ = {};
-        };
+                positions_.firstPos = std::move(root.firstPos);
+                std::ranges::sort(positions_.firstPos);
 
-        return Impl(nextAtomIndex, firstOrLast).run(n);
-    }
+                buildFollowPos(endPos + 1);
+                return std::move(positions_);
+            }
 
+        private:
+            /**
+             * @brief Attributes of a single expression node, computed from the attributes of its subexpressions.
+             */
+            struct NodeInfo {
+                std::vector<int> firstPos;
+                std::vector<int> lastPos;
+                bool nullable = true;
+            };
 
-    std::vector<Symbol> collectAtoms(const ExprNode& n) {
-        class Impl : private NodeVisitor {
-        public:
 
-            std::vector<Symbol> run(const ExprNode& n) {
+            NodeInfo visitNode(const ExprNode& n) {
                 n.accept(*this);
-                return std::move(symbols_);
+                return std::move(info_);
             }
 
-        private:
             void visit(const AtomExprNode& n) override {
-                if(!n.isNull()) {
-                    symbols_.emplace_back(n.value());
+                if(n.isNull()) {
+                    info_ = {};
+                } else {
+                    // only non-empty atoms must have positional indices assigned
+                    info_ = addAtom(n.value(), std::nullopt);
                 }
             }
 
+            void visit(const CharSetExprNode& n) override {
+                info_ = addAtom({}, n.chars());
+            }
+
             void visit(const PlusClosureNode& n) override {
-                n.inner()->accept(*this);
+                auto inner = visitNode(*n.inner());
+                addFollowPos(inner.lastPos, inner.firstPos);
+                info_ = std::move(inner);
             }
 
             void visit(const StarClosureNode& n) override {
-                n.inner()->accept(*this);
+                auto inner = visitNode(*n.inner());
+                addFollowPos(inner.lastPos, inner.firstPos);
+                info_ = std::move(inner);
+                info_.nullable = true;
             }
 
             void visit(const OptionalExprNode& n) override {
-                n.inner()->accept(*this);
+                info_ = visitNode(*n.inner());
+                info_.nullable = true;
             }
 
             void visit(const AlternExprNode& n) override {
-                n.left()->accept(*this);
-                n.right()->accept(*this);
+                auto left = visitNode(*n.left());
+                auto right = visitNode(*n.right());
+
+                info_ = {
+                    .firstPos = merge(std::move(left.firstPos), std::move(right.firstPos)),
+                    .lastPos = merge(std::move(left.lastPos), std::move(right.lastPos)),
+                    .nullable = left.nullable || right.nullable
+                };
             }
 
             void visit(const ConcatExprNode& n) override {
-                n.left()->accept(*this);
-                n.right()->accept(*this);
+                auto left = visitNode(*n.left());
+                auto right = visitNode(*n.right());
+
+                addFollowPos(left.lastPos, right.firstPos);
+                info_ = {
+                    .firstPos = left.nullable ? merge(std::move(left.firstPos), std::move(right.firstPos))
+                                              : std::move(left.firstPos),
+                    .lastPos = right.nullable ? merge(std::move(left.lastPos), std::move(right.lastPos))
+                                              : std::move(right.lastPos),
+                    .nullable = left.nullable && right.nullable
+                };
             }
 
-            std::vector<Symbol> symbols_;
-        };
-
-        return Impl().run(n);
-    }
-
 
-    std::vector<std::vector<int>> computeFollowPos(const ExprNode& n) {
-        class Impl : private NodeVisitor {
-        public:
-
-            std::vector<std::vector<int>> run(const ExprNode& n) {
-                n.accept(*this);
-
-                // make sure that the followpos sets are all sorted and contain only unique elements
-                for(auto& follow : followPos_) {
-                    const auto unique = (std::ranges::sort(follow), std::ranges::unique(follow));
-                    follow.erase(unique.begin(), unique.end());
-                }
-                return std::move(followPos_);
+            NodeInfo addAtom(Symbol symbol, std::optional<CharSet> chars) {
+                const auto pos = static_cast<int>(positions_.symbols.size());
+                positions_.symbols.push_back(std::move(symbol));
+                positions_.charSets.push_back(std::move(chars));
+                return { .firstPos = { pos }, .lastPos = { pos }, .nullable = false };
             }
 
-        private:
-            void visit(const AtomExprNode& /* n*/) override {
-                atomCount_++;
-            }
-
-            void visit(const PlusClosureNode& n) override {
-                addFirstPosToLastPos(*n.inner(), *n.inner(), atomCount_);
-                n.inner()->accept(*this);
-            }
+            void addFollowPos(const std::vector<int>& lastPos, const std::vector<int>& firstPos) {
+                if(lastPos.empty() || firstPos.empty()) {
+                    return;
+                }
 
-            void visit(const StarClosureNode& n) override {
-                addFirstPosToLastPos(*n.inner(), *n.inner(), atomCount_);
-                n.inner()->accept(*this);
-            }
+                // every position from the 'lastpos' set shares the same copy of the 'firstpos' set
+                const auto first = static_cast<int>(followLists_.size());
+                followLists_.insert(followLists_.end(), firstPos.begin(), firstPos.end());
+                const auto last = static_cast<int>(followLists_.size());
 
-            void visit(const OptionalExprNode& n) override {
-                n.inner()->accept(*this);
+                for(const auto pos : lastPos) {
+                    followLinks_.push_back({ .pos = pos, .first = first, .last = last });
+                }
             }
 
-            void visit(const AlternExprNode& n) override {
-                n.left()->accept(*this);
-                n.right()->accept(*this);
+            static std::vector<int> merge(std::vector<int> lhs, std::vector<int> rhs) {
+                // position sets of sibling subexpressions never intersect, so it is enough to append the smaller one
+                if(lhs.size() < rhs.size()) {
+                    std::swap(lhs, rhs);
+                }
+                lhs.insert(lhs.end(), rhs.begin(), rhs.end());
+                return lhs;
             }
 
-            void visit(const ConcatExprNode& n) override {
-                const auto preLeftAtomCount = atomCount_;
-                n.left()->accept(*this);
+            void buildFollowPos(int posCount) {
+                // group the links by the position they add to
+                auto linkOffsets = std::vector<int>(posCount + 1);
+                for(const auto& link : followLinks_) {
+                    linkOffsets[link.pos + 1]++;
+                }
+                for(int pos = 0; pos < posCount; pos++) {
+                    linkOffsets[pos + 1] += linkOffsets[pos];
+                }
 
-                addFirstPosToLastPos(*n.left(), *n.right(), preLeftAtomCount);
-                n.right()->accept(*this);
-            }
+                auto links = std::vector<int>(followLinks_.size());
+                auto fill = std::vector<int>(linkOffsets.begin(), linkOffsets.end() - 1);
+                for(int link = 0; link < static_cast<int>(followLinks_.size()); link++) {
+                    links[fill[followLinks_[link].pos]++] = link;
+                }
 
-            void addFirstPosToLastPos(const ExprNode& last, const ExprNode& first, int lastPosBaseAtomIndex) {
-                const auto lastPos = computeFirstOrLastPos(last, lastPosBaseAtomIndex, false);
-                if(!lastPos.empty()) {
-                    const auto firstPos = computeFirstOrLastPos(first, atomCount_, true);
-                    for(const auto& pos : lastPos) {
-                        if(pos >= followPos_.size()) {
-                            followPos_.resize(pos + 1);
+                // lay out the 'followpos' sets of all positions one after another, skipping duplicates
+                auto& offsets = positions_.followPosOffsets;
+                auto& followPos = positions_.followPos;
+                auto seenBy = std::vector<int>(posCount, -1);
+
+                offsets.assign(posCount + 1, 0);
+                for(int pos = 0; pos < posCount; pos++) {
+                    offsets[pos] = static_cast<int>(followPos.size());
+                    for(int i = linkOffsets[pos]; i < linkOffsets[pos + 1]; i++) {
+                        const auto& link = followLinks_[links[i]];
+                        for(int j = link.first; j < link.last; j++) {
+                            if(const auto follow = followLists_[j]; seenBy[follow] != pos) {
+                                seenBy[follow] = pos;
+                                followPos.push_back(follow);
+                            }
                         }
-                        followPos_[pos].insert(followPos_[pos].end(), firstPos.begin(), firstPos.end());
                     }
+                    std::sort(followPos.begin() + offsets[pos], followPos.end());
                 }
+                offsets[posCount] = static_cast<int>(followPos.size());
             }
 
-            std::vector<std::vector<int>> followPos_;
-            int atomCount_ = 0;
+
+            struct FollowLink {
+                int pos = {};
+                int first = {};
+                int last = {};
+            };
+
+            std::vector<int> followLists_;
+            std::vector<FollowLink> followLinks_;
+
+            Positions positions_;
+            NodeInfo info_;
         };
 
         return Impl().run(n);
@@ -192,16 +212,63 @@ namespace {
 
 namespace parsec::bnf {
     RegularExpr::RegularExpr(NodePtr rootNode) {
-        auto state = std::make_shared<State>();
+        auto positions = computePositions(*rootNode);
 
-        const auto regex = ConcatExprNode(std::move(rootNode), atom("$"));
-        state->symbols = collectAtoms(*regex.left());
-        state->firstPos = computeFirstOrLastPos(regex, 0, true);
-        state->followPos = computeFollowPos(regex);
+        auto state = std::make_shared<State>();
+        state->symbols = std::move(positions.symbols);
+        state->charSets = std::move(positions.charSets);
+        state->followPosOffsets = std::move(positions.followPosOffsets);
+        state->followPos = std::move(positions.followPos);
+        state->firstPos = std::move(positions.firstPos);
 
         state_ = std::move(state);
     }
 
     RegularExpr::RegularExpr(std::string_view regex)
         : RegularExpr(Parser::parseFrom(regex)) {}
+
+
+    std::optional<std::string> RegularExpr::literal() const {
+        if(firstPos().size() != 1 || firstPos().front() != 0) {
+            return std::nullopt;
+        }
+
+        // each position must lead to the next one only, up until the end position
+        std::string text;
+        for(int pos = 0; !isEndPos(pos); pos++) {
+            if(charSetAt(pos) || followPos(pos).size() != 1 || followPos(pos).front() != pos + 1) {
+                return std::nullopt;
+            }
+            text += valueAt(pos)->text();
+        }
+        return text;
+    }
+
+
+    bool RegularExpr::matches(std::string_view str) const {
+        auto current = std::vector<int>(firstPos().begin(), firstPos().end());
+        auto next = std::vector<int>();
+
+        for(const auto ch : str) {
+            next.clear();
+            for(const auto pos : current) {
+                if(isEndPos(pos)) {
+                    continue;
+                }
+
+                const auto* const chars = charSetAt(pos);
+                const auto matched = chars ? chars->test(static_cast<unsigned char>(ch))
+                                           : valueAt(pos)->text() == std::string_view(&ch, 1);
+                if(matched) {
+                    const auto follow = followPos(pos);
+                    next.insert(next.end(), follow.begin(), follow.end());
+                }
+            }
+
+            std::ranges::sort(next);
+            next.erase(std::ranges::unique(next).begin(), next.end());
+            std::swap(current, next);
+        }
+        return std::ranges::any_of(current, [this](int pos) { return isEndPos(pos); });
+    }
 }
@@ -1,7 +1,9 @@
 module;
 
 #include <memory>
+#include <optional>
 #include <span>
+#include <string>
 #include <string_view>
 #include <vector>
 
@@ -50,15 +52,32 @@ namespace parsec::bnf {
                 return {};
             }
 
-            if(const auto& fp = state_->followPos; pos >= 0 && pos < fp.size()) {
-                return fp[pos];
+            if(const auto& offsets = state_->followPosOffsets; pos >= 0 && pos + 1 < offsets.size()) {
+                return std::span(state_->followPos).subspan(offsets[pos], offsets[pos + 1] - offsets[pos]);
             }
             return {};
         }
 
 
+        /**
+         * @brief Characters matched by a character set atom at position, if any.
+         */
+        const regex::CharSet* charSetAt(int pos) const {
+            if(!state_) {
+                return nullptr;
+            }
+
+            if(const auto& charSets = state_->charSets; pos >= 0 && pos < charSets.size() && charSets[pos]) {
+                return &*charSets[pos];
+            }
+            return nullptr;
+        }
+
+
         /**
          * @brief Value of a symbol atom at position, if any.
+         *
+         * @details Character set atoms have an empty symbol as their value.
          */
         const Symbol* valueAt(int pos) const {
             if(!state_) {
@@ -72,6 +91,17 @@ namespace parsec::bnf {
         }
 
 
+        /**
+         * @brief Total number of positions in the expression, including the end position.
+         */
+        int posCount() const {
+            if(!state_) {
+                return 0;
+            }
+            return static_cast<int>(state_->symbols.size()) + 1;
+        }
+
+
         /**
          * @brief Check if a position is the end position.
          */
@@ -80,14 +110,32 @@ namespace parsec::bnf {
         }
 
 
+        /**
+         * @brief The only string the expression matches, if the expression is a plain sequence of symbol atoms.
+         */
+        std::optional<std::string> literal() const;
+
+
+        /**
+         * @brief Check if the expression matches a whole string, taking each character as a symbol.
+         */
+        bool matches(std::string_view str) const;
+
+
     private:
         /**
          * @brief Represents the pattern as read-only data, computed once and shared between all pattern instances.
          */
         struct State {
             std::vector<Symbol> symbols;
+            std::vector<std::optional<regex::CharSet>> charSets;
+
+            /**
+             * @brief The 'followpos' sets of all positions, stored contiguously and indexed by position offsets.
+             */
+            std::vector<int> followPosOffsets;
+            std::vector<int> followPos;
 
-            std::vector<std::vector<int>> followPos;
             std::vector<int> firstPos;
         };
 
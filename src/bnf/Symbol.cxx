@@ -0,0 +1,97 @@
+module;
+
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+module parsec.bnf;
+
+namespace parsec::bnf {
+    namespace {
+        thread_local SymbolTable* currentTable = {};
+
+
+        const std::string& emptyName() {
+            static const std::string name;
+            return name;
+        }
+
+
+        SymbolTable& processTable() {
+            // symbols created outside of any scope, for example by the tests, are never freed
+            static SymbolTable table;
+            return table;
+        }
+    }
+
+
+    SymbolTable::Scope::Scope(SymbolTable* table) noexcept
+        : previous_(std::exchange(currentTable, table)) {}
+
+
+    SymbolTable::Scope::~Scope() {
+        currentTable = previous_;
+    }
+
+
+    SymbolTable* SymbolTable::current() noexcept {
+        return currentTable ? currentTable : &processTable();
+    }
+
+
+    SymbolTable::SymbolTable(bool concurrent)
+        : concurrent_(concurrent) {
+        // identifiers index the names, with the empty name always being the identifier 0
+        names_.emplace_back();
+    }
+
+
+    std::pair<const std::string*, int> SymbolTable::intern(std::string_view name) {
+        if(name.empty()) {
+            return { &emptyName(), 0 };
+        }
+
+        if(!concurrent_) {
+            return insert(name);
+        }
+
+        {
+            const auto lock = std::shared_lock(mutex_);
+            if(const auto it = ids_.find(name); it != ids_.end()) {
+                return { &names_[it->second], it->second };
+            }
+        }
+
+        const auto lock = std::unique_lock(mutex_);
+        return insert(name);
+    }
+
+
+    int SymbolTable::nameCount() const {
+        const auto lock = std::shared_lock(mutex_);
+        return static_cast<int>(names_.size()) - 1;
+    }
+
+
+    std::pair<const std::string*, int> SymbolTable::insert(std::string_view name) {
+        if(const auto it = ids_.find(name); it != ids_.end()) {
+            return { &names_[it->second], it->second };
+        }
+
+        // std::deque never moves its elements on insertion at the end, so the references stay valid
+        const auto id = static_cast<int>(names_.size());
+        const auto& stored = names_.emplace_back(name);
+        ids_.emplace(stored, id);
+        return { &stored, id };
+    }
+
+
+    Symbol Symbol::intern(std::string_view str) {
+        const auto [text, id] = SymbolTable::current()->intern(str);
+        return Symbol(text, id);
+    }
+}
@@ -2,26 +2,105 @@ module;
 
 #include <compare>
 #include <cstddef>
+#include <deque>
 #include <functional>
-#include <memory>
+#include <shared_mutex>
 #include <string>
 #include <string_view>
+#include <unordered_map>
+#include <utility>
 
 export module parsec.bnf:Symbol;
 
 namespace parsec::bnf {
 
+    /**
+     * @brief Storage for the names of symbols, which gives each of the names a unique integer identifier.
+     *
+     * @details A table keeps every name interned into it until the table is destroyed, so it grows with each new name.
+     * Symbols are interned into the table made current on their thread by a SymbolTable::Scope, and into
+     * a process-wide table that is never freed if there is none. The compiler makes a table of its own for each
+     * compilation. Symbols must not outlive their table, and symbols from different tables must not be compared.
+     */
+    export class SymbolTable {
+    public:
+
+        /**
+         * @brief Makes a table current on the calling thread, until the scope ends.
+         */
+        class Scope {
+        public:
+
+            explicit Scope(SymbolTable* table) noexcept;
+
+            Scope(const Scope&) = delete;
+            Scope& operator=(const Scope&) = delete;
+
+            ~Scope();
+
+        private:
+            SymbolTable* previous_ = {};
+        };
+
+
+        /**
+         * @brief The table that symbols are interned into on the calling thread.
+         */
+        static SymbolTable* current() noexcept;
+
+
+        /**
+         * @brief Construct an empty table.
+         * @param concurrent Whether symbols are interned into the table from several threads at once,
+         *      only then are the lookups guarded by a lock.
+         */
+        explicit SymbolTable(bool concurrent = true);
+
+        SymbolTable(const SymbolTable&) = delete;
+        SymbolTable& operator=(const SymbolTable&) = delete;
+
+        ~SymbolTable() = default;
+
+
+        /**
+         * @brief Find the stored copy of a name and its identifier, adding the name if it is not in the table yet.
+         */
+        std::pair<const std::string*, int> intern(std::string_view name);
+
+
+        /**
+         * @brief Number of different non-empty names in the table.
+         */
+        int nameCount() const;
+
+
+    private:
+        std::pair<const std::string*, int> insert(std::string_view name);
+
+        std::deque<std::string> names_;
+        std::unordered_map<std::string_view, int> ids_;
+        mutable std::shared_mutex mutex_;
+        bool concurrent_ = true;
+    };
+
+
     /**
      * @brief Immutable symbolic name.
+     *
+     * @details Symbols are interned into the current SymbolTable, so that equal names share the same integer identifier
+     * and can be hashed and compared for equality without looking at their text.
      */
     export class Symbol {
     public:
 
         friend bool operator==(const Symbol& lhs, const Symbol& rhs) noexcept {
-            return lhs.text() == rhs.text();
+            return lhs.id_ == rhs.id_;
         }
 
         friend std::strong_ordering operator<=>(const Symbol& lhs, const Symbol& rhs) noexcept {
+            if(lhs.id_ == rhs.id_) {
+                return std::strong_ordering::equal;
+            }
             return lhs.text() <=> rhs.text();
         }
 
@@ -51,7 +130,7 @@ namespace parsec::bnf {
          * @brief Construct a symbol from an arbitrary character sequence.
          */
         Symbol(std::string_view str = "")
-            : text_(std::make_shared<std::string>(str)) {}
+            : Symbol(intern(str)) {}
 
 
         /**
@@ -62,6 +141,14 @@ namespace parsec::bnf {
         }
 
 
+        /**
+         * @brief Unique integer identifier of the symbol's name, with 0 reserved for the empty name.
+         */
+        int id() const noexcept {
+            return id_;
+        }
+
+
         /**
          * @brief Check if the symbol has a non-empty value.
          */
@@ -74,12 +161,18 @@ namespace parsec::bnf {
          * @brief Check if the symbol has an empty value.
          */
         bool isEmpty() const noexcept {
-            return text_->empty();
+            return id_ == 0;
         }
 
 
     private:
-        std::shared_ptr<std::string> text_;
+        Symbol(const std::string* text, int id) noexcept
+            : text_(text), id_(id) {}
+
+        static Symbol intern(std::string_view str);
+
+        const std::string* text_ = {};
+        int id_ = {};
     };
 
 }
@@ -87,6 +180,6 @@ namespace parsec::bnf {
 template <>
 struct std::hash<parsec::bnf::Symbol> {
     std::size_t operator()(const parsec::bnf::Symbol& symbol) const noexcept {
-        return std::hash<std::string>()(symbol.text());
+        return std::hash<int>()(symbol.id());
     }
 };
@@ -0,0 +1,299 @@
+module;
+
+#include <algorithm>
+#include <map>
+#include <queue>
+#include <span>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+module parsec.fsm;
+
+import parsec.bnf;
+
+namespace parsec::fsm {
+    namespace {
+        /**
+         * @brief Partition of a set of elements into disjoint blocks that can be refined by marking elements.
+         */
+        class Partition {
+        public:
+
+            Partition(std::vector<int> blocks, int blockCount)
+                : blockOf_(std::move(blocks)), blocks_(blockCount) {
+                elements_.resize(blockOf_.size());
+                location_.resize(blockOf_.size());
+
+                for(const auto block : blockOf_) {
+                    blocks_[block].last++;
+                }
+
+                int first = 0;
+                for(auto& block : blocks_) {
+                    const auto size = block.last;
+                    block.first = block.last = first;
+                    first += size;
+                }
+
+                for(int elem = 0; elem < static_cast<int>(blockOf_.size()); elem++) {
+                    auto& block = blocks_[blockOf_[elem]];
+                    location_[elem] = block.last;
+                    elements_[block.last++] = elem;
+                }
+            }
+
+
+            int blockCount() const noexcept {
+                return static_cast<int>(blocks_.size());
+            }
+
+            int blockOf(int elem) const noexcept {
+                return blockOf_[elem];
+            }
+
+            std::span<const int> elementsOf(int block) const noexcept {
+                const auto& b = blocks_[block];
+                return std::span(elements_).subspan(b.first, b.last - b.first);
+            }
+
+
+            void mark(int elem) {
+                const auto blockId = blockOf_[elem];
+                auto& block = blocks_[blockId];
+
+                const auto markEnd = block.first + block.marked;
+                if(location_[elem] < markEnd) {
+                    return;
+                }
+
+                // move the element to the marked front part of its block
+                const auto other = elements_[markEnd];
+                std::swap(elements_[location_[elem]], elements_[markEnd]);
+                location_[other] = location_[elem];
+                location_[elem] = markEnd;
+
+                if(block.marked++ == 0) {
+                    touched_.push_back(blockId);
+                }
+            }
+
+
+            /**
+             * @brief Move marked elements of each partially marked block to a new block.
+             */
+            template <typename F>
+            void split(F&& onSplit) {
+                for(const auto blockId : touched_) {
+                    const auto marked = std::exchange(blocks_[blockId].marked, 0);
+                    const auto first = blocks_[blockId].first;
+                    if(marked == blocks_[blockId].last - first) {
+                        continue;
+                    }
+
+                    const auto newBlockId = blockCount();
+                    blocks_.push_back({ .first = first, .last = first + marked });
+                    blocks_[blockId].first = first + marked;
+
+                    for(const auto elem : elementsOf(newBlockId)) {
+                        blockOf_[elem] = newBlockId;
+                    }
+                    onSplit(blockId, newBlockId);
+                }
+                touched_.clear();
+            }
+
+
+        private:
+            struct Block {
+                int first = {};
+                int last = {};
+                int marked = {};
+            };
+
+            std::vector<int> blockOf_;
+            std::vector<int> elements_;
+            std::vector<int> location_;
+
+            std::vector<Block> blocks_;
+            std::vector<int> touched_;
+        };
+    }
+
+
+    void DfaMinimizer::addState(int id) {
+        if(id >= static_cast<int>(states_.size())) {
+            states_.resize(id + 1);
+        }
+        inputStateCount_ = static_cast<int>(states_.size());
+    }
+
+
+    void DfaMinimizer::addStateTransition(int state, int target, const bnf::Symbol& label) {
+        states_[state].transitions.emplace_back(label, target);
+    }
+
+
+    void DfaMinimizer::setStateMatch(int state, const bnf::Symbol& match) {
+        states_[state].match = match;
+    }
+
+
+    void DfaMinimizer::flush() {
+        const auto stateCount = static_cast<int>(states_.size());
+        if(stateCount == 0) {
+            outputStateCount_ = 0;
+            return;
+        }
+
+        // number the transition labels
+        std::unordered_map<bnf::Symbol, int> labelIds;
+        for(const auto& state : states_) {
+            for(const auto& [label, target] : state.transitions) {
+                labelIds.try_emplace(label, static_cast<int>(labelIds.size()));
+            }
+        }
+        const auto labelCount = static_cast<int>(labelIds.size());
+
+        // complete the automaton with a dead state receiving all missing transitions
+        const auto deadState = stateCount;
+        const auto totalStateCount = stateCount + 1;
+
+        auto targets = std::vector<int>(totalStateCount * labelCount, deadState);
+        for(int state = 0; state < stateCount; state++) {
+            for(const auto& [label, target] : states_[state].transitions) {
+                targets[state * labelCount + labelIds.at(label)] = target;
+            }
+        }
+
+        // collect the reverse transitions, grouped by the target and the label
+        auto predOffsets = std::vector<int>(totalStateCount * labelCount + 1);
+        for(int state = 0; state < totalStateCount; state++) {
+            for(int label = 0; label < labelCount; label++) {
+                predOffsets[targets[state * labelCount + label] * labelCount + label + 1]++;
+            }
+        }
+        for(std::size_t i = 1; i < predOffsets.size(); i++) {
+            predOffsets[i] += predOffsets[i - 1];
+        }
+
+        auto preds = std::vector<int>(totalStateCount * labelCount);
+        auto predFill = std::vector<int>(predOffsets.begin(), predOffsets.end() - 1);
+        for(int state = 0; state < totalStateCount; state++) {
+            for(int label = 0; label < labelCount; label++) {
+                preds[predFill[targets[state * labelCount + label] * labelCount + label]++] = state;
+            }
+        }
+
+        // states are initially distinguished only by the symbol they match
+        std::map<bnf::Symbol, int> matchBlocks;
+        auto initialBlocks = std::vector<int>(totalStateCount);
+        for(int state = 0; state < totalStateCount; state++) {
+            const auto& match = state != deadState ? states_[state].match : bnf::Symbol();
+            initialBlocks[state] = matchBlocks.try_emplace(match, static_cast<int>(matchBlocks.size())).first->second;
+        }
+
+        auto partition = Partition(std::move(initialBlocks), static_cast<int>(matchBlocks.size()));
+
+        // refine the partition using the Hopcroft's algorithm
+        std::vector<std::pair<int, int>> splitters;
+        auto isSplitter = std::vector<char>(totalStateCount * labelCount);
+
+        const auto addSplitter = [&](int block, int label) {
+            splitters.emplace_back(block, label);
+            isSplitter[block * labelCount + label] = true;
+        };
+
+        for(int block = 0; block < partition.blockCount(); block++) {
+            for(int label = 0; label < labelCount; label++) {
+                addSplitter(block, label);
+            }
+        }
+
+        std::vector<int> splitterStates;
+        while(!splitters.empty()) {
+            const auto [block, label] = splitters.back();
+            splitters.pop_back();
+            isSplitter[block * labelCount + label] = false;
+
+            const auto elements = partition.elementsOf(block);
+            splitterStates.assign(elements.begin(), elements.end());
+
+            for(const auto target : splitterStates) {
+                const auto predsKey = target * labelCount + label;
+                for(int i = predOffsets[predsKey]; i < predOffsets[predsKey + 1]; i++) {
+                    partition.mark(preds[i]);
+                }
+            }
+
+            partition.split([&](int oldBlock, int newBlock) {
+                const auto oldSize = partition.elementsOf(oldBlock).size();
+                const auto newSize = partition.elementsOf(newBlock).size();
+                for(int splitLabel = 0; splitLabel < labelCount; splitLabel++) {
+                    if(isSplitter[oldBlock * labelCount + splitLabel] || newSize <= oldSize) {
+                        addSplitter(newBlock, splitLabel);
+                    } else {
+                        addSplitter(oldBlock, splitLabel);
+                    }
+                }
+            });
+        }
+
+        // renumber the remaining blocks in the breadth-first order, starting from the block of the start state
+        auto blockStates = std::vector<int>(partition.blockCount(), -1);
+        auto representatives = std::vector<int>(partition.blockCount(), -1);
+        for(int state = 0; state < stateCount; state++) {
+            auto& representative = representatives[partition.blockOf(state)];
+            if(representative == -1) {
+                representative = state;
+            }
+        }
+
+        const auto deadBlock = partition.blockOf(deadState);
+        std::vector<int> blockOrder;
+        std::queue<int> unvisited;
+
+        blockStates[partition.blockOf(0)] = 0;
+        unvisited.push(partition.blockOf(0));
+        while(!unvisited.empty()) {
+            const auto block = unvisited.front();
+            unvisited.pop();
+            blockOrder.push_back(block);
+
+            for(const auto& [label, target] : states_[representatives[block]].transitions) {
+                const auto targetBlock = partition.blockOf(target);
+                if(targetBlock != deadBlock && blockStates[targetBlock] == -1) {
+                    blockStates[targetBlock] = static_cast<int>(blockOrder.size() + unvisited.size());
+                    unvisited.push(targetBlock);
+                }
+            }
+        }
+
+        outputStateCount_ = static_cast<int>(blockOrder.size());
+        if(!sink_) {
+            return;
+        }
+
+        for(int state = 0; state < outputStateCount_; state++) {
+            sink_->addState(state);
+        }
+
+        for(int state = 0; state < outputStateCount_; state++) {
+            const auto& representative = states_[representatives[blockOrder[state]]];
+
+            std::vector<std::pair<bnf::Symbol, int>> transitions;
+            for(const auto& [label, target] : representative.transitions) {
+                const auto targetBlock = partition.blockOf(target);
+                if(targetBlock != deadBlock) {
+                    transitions.emplace_back(label, blockStates[targetBlock]);
+                }
+            }
+            sink_->addStateTransitions(state, std::move(transitions));
+
+            if(representative.match) {
+                sink_->setStateMatch(state, representative.match);
+            }
+        }
+    }
+
+}
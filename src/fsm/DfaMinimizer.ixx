@@ -0,0 +1,86 @@
+module;
+
+#include <utility>
+#include <vector>
+
+export module parsec.fsm:DfaMinimizer;
+
+import parsec.bnf;
+
+import :DfaStateGen;
+
+namespace parsec::fsm {
+
+    /**
+     * @brief Merges equivalent states of a DFA automaton before passing them on to another StateSink.
+     */
+    export class DfaMinimizer : public DfaStateGen::StateSink {
+    public:
+
+        DfaMinimizer() = default;
+
+        DfaMinimizer(const DfaMinimizer&) = delete;
+        DfaMinimizer& operator=(const DfaMinimizer&) = delete;
+
+        DfaMinimizer(DfaMinimizer&&) noexcept = default;
+        DfaMinimizer& operator=(DfaMinimizer&&) noexcept = default;
+
+        ~DfaMinimizer() = default;
+
+
+        /** @{ */
+        /**
+         * @brief Set a sink to receive the minimized states.
+         */
+        DfaMinimizer& setStateSink(DfaStateGen::StateSink* sink) {
+            sink_ = sink;
+            return *this;
+        }
+
+
+        /**
+         * @brief Minimize all states received so far and pass them on to the sink.
+         */
+        void flush();
+
+
+        /**
+         * @brief Number of states received before the minimization.
+         */
+        int inputStateCount() const noexcept {
+            return inputStateCount_;
+        }
+
+
+        /**
+         * @brief Number of states passed on to the sink after the minimization.
+         */
+        int outputStateCount() const noexcept {
+            return outputStateCount_;
+        }
+        /** @} */
+
+
+        /** @{ */
+        void addState(int id) override;
+
+        void addStateTransition(int state, int target, const bnf::Symbol& label) override;
+
+        void setStateMatch(int state, const bnf::Symbol& match) override;
+        /** @} */
+
+
+    private:
+        struct State {
+            std::vector<std::pair<bnf::Symbol, int>> transitions;
+            bnf::Symbol match;
+        };
+
+        std::vector<State> states_;
+        DfaStateGen::StateSink* sink_ = {};
+
+        int inputStateCount_ = 0;
+        int outputStateCount_ = 0;
+    };
+
+}
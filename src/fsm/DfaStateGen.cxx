@@ -2,35 +2,69 @@ module;
 
 #include <boost/functional/hash.hpp>
 
-#include <optional>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
 #include <unordered_map>
-#include <unordered_set>
+#include <utility>
+#include <vector>
 
 module parsec.fsm;
 
 import parsec.bnf;
+import parsec.regex;
 
 namespace parsec::fsm {
     namespace {
-        struct Item;
-    }
-}
+        constexpr int CharCount = 256;
 
-template <>
-struct boost::hash<parsec::fsm::Item> {
-    std::size_t operator()(const auto& item) const noexcept {
-        return boost::hash_value(std::tuple(item.rule, item.pos));
-    }
-};
 
-namespace parsec::fsm {
-    namespace {
-        struct Item {
+        /**
+         * @brief Sorted list of unique item indices, with its hash computed once upon construction.
+         */
+        class ItemSet {
+        public:
 
-            friend bool operator==(const Item& lhs, const Item& rhs) noexcept {
-                return std::tuple(lhs.rule, lhs.pos) == std::tuple(rhs.rule, rhs.pos);
+            friend bool operator==(const ItemSet& lhs, const ItemSet& rhs) noexcept {
+                return lhs.hash_ == rhs.hash_ && lhs.items_ == rhs.items_;
             }
 
+            explicit ItemSet(std::vector<int> items)
+                : items_(std::move(items)) {
+                std::ranges::sort(items_);
+                items_.erase(std::ranges::unique(items_).begin(), items_.end());
+                hash_ = boost::hash_range(items_.begin(), items_.end());
+            }
+
+            const std::vector<int>& items() const noexcept {
+                return items_;
+            }
+
+            std::size_t hash() const noexcept {
+                return hash_;
+            }
+
+        private:
+            std::vector<int> items_;
+            std::size_t hash_ = {};
+        };
+
+
+        struct ItemSetHash {
+            std::size_t operator()(const ItemSet& items) const noexcept {
+                return items.hash();
+            }
+        };
+
+
+        /**
+         * @brief Position within one of the grammar rules.
+         */
+        struct Item {
             const bnf::Symbol* value() const {
                 return rule->valueAt(pos);
             }
@@ -44,8 +78,6 @@ namespace parsec::fsm {
             int pos = {};
         };
 
-        using ItemSet = std::unordered_set<Item, boost::hash<Item>>;
-
 
         class GenerateStates {
         public:
@@ -55,17 +87,78 @@ namespace parsec::fsm {
 
             void run(const bnf::SymbolGrammar& grammar) {
                 if(auto startState = createStartState(grammar); !startState.empty()) {
-                    addState(std::move(startState));
+                    addState(ItemSet(std::move(startState)));
+                }
+
+                while(!unprocessed_.empty()) {
+                    const auto [items, id] = unprocessed_.front();
+                    unprocessed_.pop_front();
+                    addStateTransitions(*items, id);
+                }
+            }
+
+            void runConcurrently(const bnf::SymbolGrammar& grammar, int threadCount) {
+                auto startState = createStartState(grammar);
+                if(startState.empty()) {
+                    return;
+                }
+
+                workers_ = std::vector<Worker>(threadCount);
+                auto* const start = findState(ItemSet(std::move(startState)), workers_.front());
+                {
+                    std::vector<std::jthread> threads;
+                    for(int i = 1; i < threadCount; i++) {
+                        threads.emplace_back([this, i, symbols = bnf::SymbolTable::current()] {
+                            const bnf::SymbolTable::Scope scope(symbols);
+                            work(i);
+                        });
+                    }
+                    work(0);
                 }
+                renumberStates(start);
             }
 
         private:
-            static ItemSet createStartState(const bnf::SymbolGrammar& grammar) {
-                ItemSet startState;
+            /**
+             * @brief State discovered during the concurrent construction, identified by its address until renumbered.
+             */
+            struct ConcurrentState {
+                const ItemSet* items = {};
+                bnf::Symbol match;
+                std::vector<std::pair<bnf::Symbol, ConcurrentState*>> transitions;
+                std::exception_ptr error;
+                int id = -1;
+            };
+
+            /**
+             * @brief Part of the table of all discovered states, guarded by its own lock.
+             */
+            struct StateShard {
+                std::mutex mutex;
+                std::unordered_map<ItemSet, ConcurrentState, ItemSetHash> states;
+            };
+
+            /**
+             * @brief States waiting to be expanded by a worker thread, which other workers may steal when idle.
+             */
+            struct Worker {
+                std::mutex mutex;
+                std::deque<ConcurrentState*> unprocessed;
+            };
+
+
+            std::vector<int> createStartState(const bnf::SymbolGrammar& grammar) {
+                // assign each position of each rule a unique index to refer to it by
+                std::vector<int> startState;
                 for(const auto& symbol : grammar.symbols()) {
                     if(const auto* const rule = grammar.resolve(symbol)) {
+                        const auto firstItem = static_cast<int>(items_.size());
+                        for(int pos = 0; pos < rule->posCount(); pos++) {
+                            items_.push_back({ .symbol = symbol, .rule = rule, .pos = pos });
+                        }
+
                         for(const auto& pos : rule->firstPos()) {
-                            startState.emplace(symbol, rule, pos);
+                            startState.push_back(firstItem + pos);
                         }
                     }
                 }
@@ -86,47 +179,256 @@ namespace parsec::fsm {
                 const auto& [items, id] = *it;
                 if(ok) {
                     sink(&DfaStateGen::StateSink::addState, id);
-                    addStateTransitions(items, id);
+                    unprocessed_.emplace_back(&items, id);
                 }
                 return id;
             }
 
             void addStateTransitions(const ItemSet& items, int id) {
-                std::unordered_map<bnf::Symbol, ItemSet> transitions;
+                auto [match, transitions] = expandState(items);
+                if(match) {
+                    sink(&DfaStateGen::StateSink::setStateMatch, id, match);
+                }
+
+                std::vector<std::pair<bnf::Symbol, int>> targets;
+                for(auto& [label, target] : transitions) {
+                    targets.emplace_back(label, addState(ItemSet(std::move(target))));
+                }
+                sink(&DfaStateGen::StateSink::addStateTransitions, id, std::move(targets));
+            }
+
+            std::pair<bnf::Symbol, std::vector<std::pair<bnf::Symbol, std::vector<int>>>> expandState(const ItemSet& items) const {
+                std::unordered_map<bnf::Symbol, std::vector<int>> transitions;
                 bnf::Symbol match;
 
-                for(const auto& item : items) {
+                for(const auto itemIndex : items.items()) {
+                    const auto& item = items_[itemIndex];
                     if(item.isAtEnd()) {
                         if(!match) {
-                            sink(&DfaStateGen::StateSink::setStateMatch, id, item.symbol);
                             match = item.symbol;
                             continue;
                         }
                         throw NameConflictError(match, item.symbol);
                     }
 
-                    for(const auto& pos : item.rule->followPos(item.pos)) {
-                        transitions[*item.value()].emplace(item.symbol, item.rule, pos);
+                    // a character set moves the item on each of its characters at once
+                    if(const auto* const chars = item.rule->charSetAt(item.pos)) {
+                        for(int ch = 0; ch < CharCount; ch++) {
+                            if(chars->test(ch)) {
+                                addItemTransition(transitions[charSymbol(ch)], itemIndex);
+                            }
+                        }
+                    } else {
+                        addItemTransition(transitions[*item.value()], itemIndex);
                     }
                 }
 
-                for(auto& [label, target] : transitions) {
-                    const auto targetId = addState(std::move(target));
-                    sink(&DfaStateGen::StateSink::addStateTransition, id, targetId, label);
+                // visit the transitions in a fixed order to make the state numbering reproducible
+                std::vector<std::pair<bnf::Symbol, std::vector<int>>> orderedTransitions(
+                    std::make_move_iterator(transitions.begin()),
+                    std::make_move_iterator(transitions.end())
+                );
+                std::ranges::sort(orderedTransitions, {}, &std::pair<bnf::Symbol, std::vector<int>>::first);
+                return { match, std::move(orderedTransitions) };
+            }
+
+            void addItemTransition(std::vector<int>& target, int itemIndex) const {
+                const auto& item = items_[itemIndex];
+                const auto firstItem = itemIndex - item.pos;
+                for(const auto& pos : item.rule->followPos(item.pos)) {
+                    target.push_back(firstItem + pos);
                 }
             }
 
 
-            std::unordered_map<ItemSet, int, boost::hash<ItemSet>> states_;
+            ConcurrentState* findState(ItemSet&& items, Worker& worker) {
+                auto& shard = stateShards_[items.hash() % StateShardCount];
+
+                ConcurrentState* state = {};
+                {
+                    const auto lock = std::lock_guard(shard.mutex);
+                    const auto [it, ok] = shard.states.try_emplace(std::move(items));
+                    if(!ok) {
+                        return &it->second;
+                    }
+                    state = &it->second;
+                    state->items = &it->first;
+                }
+
+                // a new state is expanded by the worker that discovered it, unless it is stolen first
+                pendingStateCount_++;
+                {
+                    const auto lock = std::lock_guard(worker.mutex);
+                    worker.unprocessed.push_back(state);
+                }
+                notifyWorkers(false);
+                return state;
+            }
+
+            ConcurrentState* takeState(int workerIndex) {
+                {
+                    auto& worker = workers_[workerIndex];
+                    const auto lock = std::lock_guard(worker.mutex);
+                    if(!worker.unprocessed.empty()) {
+                        auto* const state = worker.unprocessed.back();
+                        worker.unprocessed.pop_back();
+                        return state;
+                    }
+                }
+
+                // steal the oldest state of another worker, as it is likely to lead to the most undiscovered states
+                const auto workerCount = static_cast<int>(workers_.size());
+                for(int i = 1; i < workerCount; i++) {
+                    auto& victim = workers_[(workerIndex + i) % workerCount];
+                    const auto lock = std::lock_guard(victim.mutex);
+                    if(!victim.unprocessed.empty()) {
+                        auto* const state = victim.unprocessed.front();
+                        victim.unprocessed.pop_front();
+                        return state;
+                    }
+                }
+                return nullptr;
+            }
+
+            void notifyWorkers(bool all) {
+                queueVersion_++;
+                if(all) {
+                    queueVersion_.notify_all();
+                } else {
+                    queueVersion_.notify_one();
+                }
+            }
+
+            void work(int workerIndex) {
+                while(pendingStateCount_ > 0) {
+                    // a state queued or the work finished after this point changes the version and ends the wait below
+                    const auto version = queueVersion_.load();
+                    auto* const state = takeState(workerIndex);
+                    if(!state) {
+                        if(pendingStateCount_ > 0) {
+                            queueVersion_.wait(version);
+                        }
+                        continue;
+                    }
+
+                    try {
+                        auto [match, transitions] = expandState(*state->items);
+                        state->match = match;
+                        for(auto& [label, target] : transitions) {
+                            state->transitions.emplace_back(label, findState(ItemSet(std::move(target)), workers_[workerIndex]));
+                        }
+                    } catch(...) {
+                        state->error = std::current_exception();
+                    }
+
+                    if(--pendingStateCount_ == 0) {
+                        notifyWorkers(true);
+                    }
+                }
+            }
+
+            void renumberStates(ConcurrentState* start) {
+                // replay the discovered states in the breadth-first order of the sequential construction to assign them the same identifiers
+                std::deque<ConcurrentState*> unprocessed;
+                int stateCount = 0;
+                const auto numberState = [this, &unprocessed, &stateCount](ConcurrentState* state) {
+                    if(state->id == -1) {
+                        state->id = stateCount++;
+                        sink(&DfaStateGen::StateSink::addState, state->id);
+                        unprocessed.push_back(state);
+                    }
+                    return state->id;
+                };
+
+                numberState(start);
+                while(!unprocessed.empty()) {
+                    auto* const state = unprocessed.front();
+                    unprocessed.pop_front();
+                    if(state->error) {
+                        std::rethrow_exception(state->error);
+                    }
+
+                    if(state->match) {
+                        sink(&DfaStateGen::StateSink::setStateMatch, state->id, state->match);
+                    }
+
+                    std::vector<std::pair<bnf::Symbol, int>> targets;
+                    for(const auto& [label, target] : state->transitions) {
+                        targets.emplace_back(label, numberState(target));
+                    }
+                    sink(&DfaStateGen::StateSink::addStateTransitions, state->id, std::move(targets));
+                }
+            }
+
+
+            const bnf::Symbol& charSymbol(int ch) const {
+                // the symbols belong to the table of the current compilation, so they cannot be shared between generators
+                std::call_once(charSymbolsInit_, [this] {
+                    for(int ch = 0; ch < CharCount; ch++) {
+                        charSymbols_[ch] = bnf::Symbol(static_cast<char>(ch));
+                    }
+                });
+                return charSymbols_[ch];
+            }
+
+
+            static constexpr std::size_t StateShardCount = 64;
+
+            std::vector<Item> items_;
+
+            std::unordered_map<ItemSet, int, ItemSetHash> states_;
+            std::deque<std::pair<const ItemSet*, int>> unprocessed_;
+
+            std::array<StateShard, StateShardCount> stateShards_;
+            std::vector<Worker> workers_;
+            std::atomic<int> pendingStateCount_ = 0;
+            std::atomic<unsigned> queueVersion_ = 0;
+
+            mutable std::array<bnf::Symbol, CharCount> charSymbols_;
+            mutable std::once_flag charSymbolsInit_;
+
             DfaStateGen::StateSink* sink_ = {};
         };
     }
 
 
+    void DfaStateGen::StateSink::addStateTransitions(int state, std::vector<std::pair<bnf::Symbol, int>> transitions) {
+        std::ranges::sort(transitions, {}, &std::pair<bnf::Symbol, int>::first);
+
+        const auto charCode = [](const bnf::Symbol& label) {
+            return label.text().size() == 1 ? static_cast<int>(static_cast<unsigned char>(label.text().front())) : -1;
+        };
+
+        for(std::size_t i = 0; i < transitions.size();) {
+            const auto& [label, target] = transitions[i];
+            const auto first = charCode(label);
+
+            // extend the range for as long as the next character follows the previous one and leads to the same target
+            auto last = first;
+            auto end = i + 1;
+            while(first != -1 && end < transitions.size() && transitions[end].second == target
+                  && charCode(transitions[end].first) == last + 1) {
+                last++;
+                end++;
+            }
+
+            if(last != first) {
+                addStateRangeTransition(state, target, first, last);
+            } else {
+                addStateTransition(state, target, label);
+            }
+            i = end;
+        }
+    }
+
+
     void DfaStateGen::generate() {
         if(grammar_) {
-            GenerateStates(sink_)
-                .run(*grammar_);
+            if(threadCount_ > 1) {
+                GenerateStates(sink_).runConcurrently(*grammar_, threadCount_);
+            } else {
+                GenerateStates(sink_).run(*grammar_);
+            }
         }
     }
 }
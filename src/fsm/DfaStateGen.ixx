@@ -1,3 +1,8 @@
+module;
+
+#include <utility>
+#include <vector>
+
 export module parsec.fsm:DfaStateGen;
 
 import parsec.bnf;
@@ -28,11 +33,29 @@ namespace parsec::fsm {
             virtual void addStateTransition(int state, int target, const bnf::Symbol& label) = 0;
 
 
+            /**
+             * @brief Create transitions between two states on every character from an inclusive range of character codes.
+             *
+             * @details By default, the range is reported as a separate transition on each of its characters.
+             */
+            virtual void addStateRangeTransition(int state, int target, int first, int last) {
+                for(int ch = first; ch <= last; ch++) {
+                    addStateTransition(state, target, bnf::Symbol(static_cast<char>(ch)));
+                }
+            }
+
+
             /**
              * @brief Set a match for a state to report if there is no transition to take.
              */
             virtual void setStateMatch(int state, const bnf::Symbol& match) = 0;
 
+
+            /**
+             * @brief Report all transitions of a state, merging runs of consecutive characters that lead to the same target into ranges.
+             */
+            void addStateTransitions(int state, std::vector<std::pair<bnf::Symbol, int>> transitions);
+
         protected:
             ~StateSink() = default;
         };
@@ -68,6 +91,17 @@ namespace parsec::fsm {
         }
 
 
+        /**
+         * @brief Set the number of threads to explore the states with.
+         *
+         * @details The states are numbered in the same way regardless of the number of threads.
+         */
+        DfaStateGen& setThreadCount(int count) {
+            threadCount_ = count;
+            return *this;
+        }
+
+
         /**
          * @brief Start the generation process.
          */
@@ -78,6 +112,7 @@ namespace parsec::fsm {
     private:
         const bnf::SymbolGrammar* grammar_ = {};
         StateSink* sink_ = {};
+        int threadCount_ = 1;
     };
 
 }
@@ -1,38 +1,71 @@
 module;
 
+#include <boost/dynamic_bitset.hpp>
 #include <boost/functional/hash.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <exception>
+#include <thread>
 #include <unordered_map>
-#include <unordered_set>
+#include <utility>
+#include <vector>
 
 module parsec.fsm;
 
 import parsec.bnf;
 
-namespace parsec::fsm {
-    namespace {
-        struct Item;
-    }
-}
-
-template <>
-struct boost::hash<parsec::fsm::Item> {
-    std::size_t operator()(const auto& item) const noexcept {
-        return boost::hash_value(std::tuple(item.dfaState, item.backlink));
-    }
-};
-
 namespace parsec::fsm {
     namespace {
         struct Item {
 
-            friend bool operator==(const Item& lhs, const Item& rhs) = default;
+            friend auto operator<=>(const Item& lhs, const Item& rhs) = default;
 
             int dfaState = {};
             int backlink = -1;
         };
 
-        using ItemSet = std::unordered_set<Item, boost::hash<Item>>;
+
+        /**
+         * @brief Sorted list of unique items, with its hash computed once upon construction.
+         */
+        class ItemSet {
+        public:
+
+            friend bool operator==(const ItemSet& lhs, const ItemSet& rhs) noexcept {
+                return lhs.hash_ == rhs.hash_ && lhs.items_ == rhs.items_;
+            }
+
+            explicit ItemSet(std::vector<Item> items)
+                : items_(std::move(items)) {
+                std::ranges::sort(items_);
+                items_.erase(std::ranges::unique(items_).begin(), items_.end());
+                for(const auto& item : items_) {
+                    boost::hash_combine(hash_, item.dfaState);
+                    boost::hash_combine(hash_, item.backlink);
+                }
+            }
+
+            const std::vector<Item>& items() const noexcept {
+                return items_;
+            }
+
+            std::size_t hash() const noexcept {
+                return hash_;
+            }
+
+        private:
+            std::vector<Item> items_;
+            std::size_t hash_ = {};
+        };
+
+
+        struct ItemSetHash {
+            std::size_t operator()(const ItemSet& items) const noexcept {
+                return items.hash();
+            }
+        };
 
 
         struct DfaStateTrans {
@@ -42,56 +75,122 @@ namespace parsec::fsm {
 
         struct DfaState {
             std::vector<DfaStateTrans> transitions;
+            std::vector<int> enteredRules;
             bnf::Symbol match;
             int id = {};
+            int rule = {};
         };
 
 
         class GenDfaStates : DfaStateGen::StateSink {
         public:
 
-            GenDfaStates(std::vector<DfaState>* states, int baseStateId)
-                : states_(states), baseStateId_(baseStateId) {}
+            explicit GenDfaStates(std::vector<DfaState>* states)
+                : states_(states) {}
 
             void run(const bnf::SymbolGrammar& grammar) {
+                minimizer_.setStateSink(this);
                 DfaStateGen()
                     .setInputGrammar(&grammar)
-                    .setStateSink(this)
+                    .setStateSink(&minimizer_)
                     .generate();
+                minimizer_.flush();
+            }
+
+            const DfaMinimizer& minimizer() const noexcept {
+                return minimizer_;
             }
 
         private:
             void addState(int id) override {
                 auto& s = states_->emplace_back();
-                s.id = id + baseStateId_;
+                s.id = id;
             }
 
             void addStateTransition(int state, int target, const bnf::Symbol& label) override {
-                (*states_)[state + baseStateId_].transitions.emplace_back(target + baseStateId_, label);
+                (*states_)[state].transitions.emplace_back(target, label);
             }
 
             void setStateMatch(int state, const bnf::Symbol& match) override {
-                (*states_)[state + baseStateId_].match = match;
+                (*states_)[state].match = match;
             }
 
+            DfaMinimizer minimizer_;
             std::vector<DfaState>* states_;
-            int baseStateId_ = {};
+        };
+
+
+        /**
+         * @brief States of a single rule's DFA automaton, numbered from 0.
+         */
+        struct RuleDfa {
+            std::vector<DfaState> states;
+            int inputStateCount = 0;
+            std::exception_ptr error;
         };
 
 
         class TransNetwork {
         public:
 
-            TransNetwork(const bnf::SymbolGrammar& grammar) {
+            TransNetwork(const bnf::SymbolGrammar& grammar, int threadCount) {
+                std::vector<std::pair<bnf::Symbol, const bnf::RegularExpr*>> rules;
                 for(const auto& symbol : grammar.symbols()) {
                     if(const auto* const rule = grammar.resolve(symbol)) {
-                        const auto startStateId = static_cast<int>(states_.size());
-                        startStates_[symbol] = startStateId;
+                        rules.emplace_back(symbol, rule);
+                    }
+                }
 
-                        GenDfaStates(&states_, startStateId)
-                            .run(bnf::SymbolGrammar().define(symbol, *rule));
+                // the automata of different rules are independent of each other, so they can be built concurrently
+                std::vector<RuleDfa> ruleDfas(rules.size());
+                std::atomic<std::size_t> nextRule = 0;
+                const auto buildRules = [&rules, &ruleDfas, &nextRule] {
+                    for(auto i = nextRule++; i < rules.size(); i = nextRule++) {
+                        const auto& [symbol, rule] = rules[i];
+                        try {
+                            GenDfaStates ruleStates(&ruleDfas[i].states);
+                            ruleStates.run(bnf::SymbolGrammar().define(symbol, *rule));
+                            ruleDfas[i].inputStateCount = ruleStates.minimizer().inputStateCount();
+                        } catch(...) {
+                            ruleDfas[i].error = std::current_exception();
+                        }
                     }
+                };
+
+                {
+                    const auto workerCount = std::min(static_cast<std::size_t>(std::max(threadCount, 1)), rules.size());
+                    std::vector<std::jthread> workers;
+                    for(std::size_t i = 1; i < workerCount; i++) {
+                        workers.emplace_back([&buildRules, symbols = bnf::SymbolTable::current()] {
+                            const bnf::SymbolTable::Scope scope(symbols);
+                            buildRules();
+                        });
+                    }
+                    buildRules();
+                }
+
+                // lay the automata out one after another in the order of the rules, so the numbering does not depend on scheduling
+                for(std::size_t i = 0; i < rules.size(); i++) {
+                    auto& [states, inputStateCount, error] = ruleDfas[i];
+                    if(error) {
+                        std::rethrow_exception(error);
+                    }
+
+                    const auto startStateId = static_cast<int>(states_.size());
+                    startStates_[rules[i].first] = startStateId;
+                    ruleStartStates_.push_back(startStateId);
+                    for(auto& state : states) {
+                        state.id += startStateId;
+                        state.rule = static_cast<int>(i);
+                        for(auto& trans : state.transitions) {
+                            trans.target += startStateId;
+                        }
+                        states_.push_back(std::move(state));
+                    }
+                    inputStateCount_ += inputStateCount;
                 }
+
+                computeRuleClosures(rules);
             }
 
 
@@ -107,25 +206,102 @@ namespace parsec::fsm {
                 return nullptr;
             }
 
+            const DfaState* ruleStartState(int rule) const noexcept {
+                return &states_[ruleStartStates_[rule]];
+            }
+
+
+            /**
+             * @brief Rules whose start states are entered from the start state of a rule, directly or through other rules, including the rule itself.
+             */
+            const boost::dynamic_bitset<>& ruleClosure(int rule) const noexcept {
+                return ruleClosures_[rule];
+            }
+
+            int ruleCount() const noexcept {
+                return static_cast<int>(ruleStartStates_.size());
+            }
+
+
+            int inputStateCount() const noexcept {
+                return inputStateCount_;
+            }
+
+            int outputStateCount() const noexcept {
+                return static_cast<int>(states_.size());
+            }
+
 
         private:
+            void computeRuleClosures(const std::vector<std::pair<bnf::Symbol, const bnf::RegularExpr*>>& rules) {
+                std::unordered_map<bnf::Symbol, int> ruleIndices;
+                for(int rule = 0; const auto& [symbol, expr] : rules) {
+                    ruleIndices[symbol] = rule++;
+                }
+
+                for(auto& state : states_) {
+                    for(const auto& trans : state.transitions) {
+                        if(const auto it = ruleIndices.find(trans.label); it != ruleIndices.end()) {
+                            state.enteredRules.push_back(it->second);
+                        }
+                    }
+                    std::ranges::sort(state.enteredRules);
+                    state.enteredRules.erase(std::ranges::unique(state.enteredRules).begin(), state.enteredRules.end());
+                }
+
+                // every closure is collected once with a worklist, even for rules that are entered from many states
+                ruleClosures_.assign(rules.size(), boost::dynamic_bitset<>(rules.size()));
+                std::vector<int> unprocessed;
+                for(int rule = 0; rule < ruleCount(); rule++) {
+                    auto& closure = ruleClosures_[rule];
+                    closure.set(rule);
+                    unprocessed.push_back(rule);
+
+                    while(!unprocessed.empty()) {
+                        const auto current = unprocessed.back();
+                        unprocessed.pop_back();
+                        for(const auto entered : ruleStartState(current)->enteredRules) {
+                            if(!closure.test(entered)) {
+                                closure.set(entered);
+                                unprocessed.push_back(entered);
+                            }
+                        }
+                    }
+                }
+            }
+
+
             std::vector<DfaState> states_;
             std::unordered_map<bnf::Symbol, int> startStates_;
+            std::vector<int> ruleStartStates_;
+            std::vector<boost::dynamic_bitset<>> ruleClosures_;
+            int inputStateCount_ = 0;
         };
 
 
         class GenerateStates {
         public:
 
-            GenerateStates(const bnf::SymbolGrammar& grammar, ElrStateGen::StateSink* sink)
-                : transNet_(grammar), grammar_(grammar), sink_(sink) {}
+            GenerateStates(const bnf::SymbolGrammar& grammar, ElrStateGen::StateSink* sink, int threadCount)
+                : transNet_(grammar, threadCount), grammar_(grammar), sink_(sink) {}
 
             void run() {
-                if(const auto startState = createStartState(); !startState.empty()) {
-                    addState(startState);
+                if(const auto* const root = grammar_.root()) {
+                    const auto startItem = Item{ .dfaState = transNet_.startState(*root)->id };
+                    addState(ItemSet({ startItem }));
+                }
+
+                while(!unprocessed_.empty()) {
+                    const auto [items, id] = std::move(unprocessed_.front());
+                    unprocessed_.pop_front();
+                    addStateTransitions(items, id);
                 }
             }
 
+            const TransNetwork& transNetwork() const noexcept {
+                return transNet_;
+            }
+
         private:
             template <typename... Params, typename... Args>
             void sink(void (ElrStateGen::StateSink::*func)(Params...), Args&&... args) {
@@ -135,53 +311,49 @@ namespace parsec::fsm {
             }
 
 
-            ItemSet createStartState() {
-                ItemSet startState;
-                if(const auto* const root = grammar_.root()) {
-                    startState.insert({ .dfaState = transNet_.startState(*root)->id });
-                }
-                return startState;
-            }
-
-
-            int addState(const ItemSet& state) {
-                const auto [it, ok] = states_.try_emplace(closure(state), static_cast<int>(states_.size()));
-                const auto& [items, id] = *it;
+            int addState(ItemSet&& kernel) {
+                // states are identified by their kernel items, as the rest of the items is implied by them
+                const auto [it, ok] = states_.emplace(std::move(kernel), static_cast<int>(states_.size()));
+                const auto& [kernelItems, id] = *it;
                 if(ok) {
+                    auto items = closure(kernelItems);
+
                     sink(&ElrStateGen::StateSink::addState, id);
                     for(const auto& item : items) {
                         sink(&ElrStateGen::StateSink::addStateBacklink, id, item.backlink);
                     }
-                    addStateTransitions(items, id);
+                    unprocessed_.emplace_back(std::move(items), id);
                 }
                 return id;
             }
 
 
-            ItemSet closure(const ItemSet& items) const {
-                ItemSet closure;
+            std::vector<Item> closure(const ItemSet& kernel) {
+                auto items = kernel.items();
+                closureRules_.resize(transNet_.ruleCount());
                 for(const auto& item : items) {
-                    closeItem(item, closure);
+                    for(const auto rule : transNet_.stateById(item.dfaState)->enteredRules) {
+                        closureRules_ |= transNet_.ruleClosure(rule);
+                    }
                 }
-                return closure;
-            }
 
-            void closeItem(const Item& item, ItemSet& closure) const {
-                if(closure.contains(item)) {
-                    return;
+                // start items without a backlink only come from the kernel, so they are already present
+                for(const auto& item : items) {
+                    if(item.backlink == -1) {
+                        closureRules_.reset(transNet_.stateById(item.dfaState)->rule);
+                    }
                 }
-                closure.insert(item);
 
-                for(const auto& trans : transNet_.stateById(item.dfaState)->transitions) {
-                    if(const auto* startState = transNet_.startState(trans.label)) {
-                        closeItem({ .dfaState = startState->id }, closure);
-                    }
+                for(auto rule = closureRules_.find_first(); rule != boost::dynamic_bitset<>::npos; rule = closureRules_.find_next(rule)) {
+                    items.push_back({ .dfaState = transNet_.ruleStartState(static_cast<int>(rule))->id });
                 }
+                closureRules_.reset();
+                return items;
             }
 
 
-            void addStateTransitions(const ItemSet& items, int id) {
-                std::unordered_map<bnf::Symbol, ItemSet> transitions;
+            void addStateTransitions(const std::vector<Item>& items, int id) {
+                std::unordered_map<bnf::Symbol, std::vector<Item>> transitions;
                 bnf::Symbol match;
 
                 for(int itemId = 0; const auto& item : items) {
@@ -197,14 +369,21 @@ namespace parsec::fsm {
                     }
 
                     for(const auto& trans : dfaState->transitions) {
-                        transitions[trans.label].emplace(trans.target, itemId);
+                        transitions[trans.label].push_back({ .dfaState = trans.target, .backlink = itemId });
                     }
 
                     itemId++;
                 }
 
-                for(const auto& [label, transTarget] : transitions) {
-                    const auto targetId = addState(transTarget);
+                // visit the transitions in a fixed order to make the state numbering reproducible
+                std::vector<std::pair<bnf::Symbol, std::vector<Item>>> orderedTransitions(
+                    std::make_move_iterator(transitions.begin()),
+                    std::make_move_iterator(transitions.end())
+                );
+                std::ranges::sort(orderedTransitions, {}, &std::pair<bnf::Symbol, std::vector<Item>>::first);
+
+                for(auto& [label, transTarget] : orderedTransitions) {
+                    const auto targetId = addState(ItemSet(std::move(transTarget)));
                     const auto addTrans = grammar_.contains(label)
                                             ? &ElrStateGen::StateSink::addStateRuleTransition
                                             : &ElrStateGen::StateSink::addStateTokenTransition;
@@ -213,7 +392,9 @@ namespace parsec::fsm {
             }
 
 
-            std::unordered_map<ItemSet, int, boost::hash<ItemSet>> states_;
+            std::unordered_map<ItemSet, int, ItemSetHash> states_;
+            std::deque<std::pair<std::vector<Item>, int>> unprocessed_;
+            boost::dynamic_bitset<> closureRules_;
             TransNetwork transNet_;
 
             const bnf::SymbolGrammar& grammar_;
@@ -224,8 +405,11 @@ namespace parsec::fsm {
 
     void ElrStateGen::generate() {
         if(grammar_) {
-            GenerateStates(*grammar_, sink_)
-                .run();
+            GenerateStates gen(*grammar_, sink_, threadCount_);
+            gen.run();
+
+            dfaInputStateCount_ = gen.transNetwork().inputStateCount();
+            dfaOutputStateCount_ = gen.transNetwork().outputStateCount();
         }
     }
 }
@@ -86,6 +86,15 @@ namespace parsec::fsm {
         }
 
 
+        /**
+         * @brief Set the number of threads to build the per-rule DFA automata with.
+         */
+        ElrStateGen& setThreadCount(int count) {
+            threadCount_ = count;
+            return *this;
+        }
+
+
         /**
          * @brief Start the generation process.
          */
@@ -93,9 +102,31 @@ namespace parsec::fsm {
         /** @} */
 
 
+        /** @{ */
+        /**
+         * @brief Total number of states in the per-rule DFA automata before their minimization.
+         */
+        int dfaInputStateCount() const noexcept {
+            return dfaInputStateCount_;
+        }
+
+
+        /**
+         * @brief Total number of states in the per-rule DFA automata after their minimization.
+         */
+        int dfaOutputStateCount() const noexcept {
+            return dfaOutputStateCount_;
+        }
+        /** @} */
+
+
     private:
         const bnf::SymbolGrammar* grammar_ = {};
         StateSink* sink_ = {};
+        int threadCount_ = 1;
+
+        int dfaInputStateCount_ = 0;
+        int dfaOutputStateCount_ = 0;
     };
 
 }
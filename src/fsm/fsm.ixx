@@ -1,6 +1,7 @@
 export module parsec.fsm;
 
 export import :DfaStateGen;
+export import :DfaMinimizer;
 export import :ElrStateGen;
 
 export import :NameConflictError;
@@ -2,10 +2,20 @@
 #include <boost/dll.hpp>
 #include <boost/program_options.hpp>
 
+#include <cstdint>
 #include <filesystem>
 #include <fstream>
+#include <initializer_list>
 #include <iostream>
+#include <iterator>
+#include <map>
+#include <optional>
+#include <random>
 #include <sstream>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
 
 import parsec;
 import parsec.config;
@@ -27,7 +37,11 @@ public:
             ("output-file,o", po::value<std::string>()->default_value("<input-file>.<template>"), "output source file") //
             ("template,t", po::value<std::string>()->default_value("json"), "output template")                          //
             ("template-dir", po::value<std::string>()->default_value(tmplDir), "template directory")                    //
+            ("define,D", po::value<std::vector<std::string>>()->composing(), "template option <name>[=<value>]")        //
             ("tab-size", po::value<std::size_t>()->default_value(4), "tab display size")                                //
+            ("jobs,j", po::value<unsigned>()->default_value(1), "number of threads (0 for one per core)")               //
+            ("cache-dir", po::value<std::string>(), "directory to cache generated files in")                            //
+            ("stats", "print statistics about the generated automata and cache hits")                                   //
             ("version", "print version information")                                                                    //
             ("help", "produce help message");                                                                           //
     }
@@ -97,17 +111,129 @@ public:
     }
 
 
+    std::vector<std::pair<std::string, std::string>> templateOptions() const {
+        std::vector<std::pair<std::string, std::string>> templateOptions;
+        if(options_.contains("define")) {
+            for(const auto& define : options_["define"].as<std::vector<std::string>>()) {
+                // options without an explicit value are treated as flags
+                if(const auto eq = define.find('='); eq != std::string::npos) {
+                    templateOptions.emplace_back(define.substr(0, eq), define.substr(eq + 1));
+                } else {
+                    templateOptions.emplace_back(define, "true");
+                }
+            }
+        }
+        return templateOptions;
+    }
+
+
     std::size_t tabSize() const {
         return options_["tab-size"].as<std::size_t>();
     }
 
 
+    int jobs() const {
+        if(const auto jobs = options_["jobs"].as<unsigned>(); jobs != 0) {
+            return static_cast<int>(jobs);
+        }
+        return static_cast<int>(std::max(std::thread::hardware_concurrency(), 1u));
+    }
+
+
+    std::string cacheDir() const {
+        if(options_.contains("cache-dir")) {
+            return options_["cache-dir"].as<std::string>();
+        }
+        return "";
+    }
+
+
+    bool printStats() const {
+        return options_.contains("stats");
+    }
+
+
 private:
     po::options_description named_;
     po::variables_map options_;
 };
 
 
+/**
+ * @brief Stores generated files on disk under a hash of everything that affects their contents.
+ * @details Each entry also records the inputs it was generated from in full, so that a hash collision is a cache miss
+ *          rather than a wrong file. Entries are never removed, the cache directory has to be cleaned up externally.
+ */
+class GenerationCache {
+public:
+
+    GenerationCache(fs::path dir, std::initializer_list<std::string_view> inputs)
+        : dir_(std::move(dir)) {
+        // each input is prefixed with its size to tell apart inputs that only differ in where one ends
+        for(const auto input : inputs) {
+            inputs_ += std::format("{}\n", input.size());
+            inputs_ += input;
+        }
+        key_ = makeKey(inputs_);
+    }
+
+
+    const std::string& key() const noexcept {
+        return key_;
+    }
+
+
+    std::optional<std::string> load() const {
+        std::ifstream entry(dir_ / key_, std::ios::binary);
+        if(!entry.is_open()) {
+            return std::nullopt;
+        }
+
+        auto contents = std::string(std::istreambuf_iterator<char>(entry), std::istreambuf_iterator<char>());
+        if(!contents.starts_with(inputs_)) {
+            return std::nullopt;
+        }
+        return contents.substr(inputs_.size());
+    }
+
+
+    void store(std::string_view output) const {
+        fs::create_directories(dir_);
+
+        // write the entry under a unique temporary name first, so that concurrent runs never see it partially written
+        const auto tmpPath = dir_ / std::format("{}.{:08x}.tmp", key_, std::random_device()());
+        {
+            std::ofstream entry(tmpPath, std::ios::binary);
+            entry.write(inputs_.data(), static_cast<std::streamsize>(inputs_.size()));
+            entry.write(output.data(), static_cast<std::streamsize>(output.size()));
+            if(!entry.flush()) {
+                entry.close();
+                auto error = std::error_code();
+                fs::remove(tmpPath, error);
+                throw std::runtime_error(std::format("failed to write the cache entry \"{}\"", tmpPath.string()));
+            }
+        }
+        fs::rename(tmpPath, dir_ / key_);
+    }
+
+
+    static std::string makeKey(std::string_view inputs) {
+        // FNV-1a, only used to name the entry
+        auto hash = std::uint64_t(0xcbf29ce484222325);
+        for(const auto ch : inputs) {
+            hash = (hash ^ static_cast<unsigned char>(ch)) * 0x100000001b3;
+        }
+        return std::format("{:016x}", hash);
+    }
+
+
+private:
+    fs::path dir_;
+    std::string inputs_;
+    std::string key_;
+};
+
+
 class ParsecApp {
 public:
 
@@ -129,6 +255,28 @@ public:
             compiler_.setOutputTemplateSource(&tmpl_);
         }
 
+        for(const auto& [name, value] : options_->templateOptions()) {
+            compiler_.setTemplateOption(name, value);
+        }
+
+        compiler_.setThreadCount(options_->jobs());
+
+        if(options_->printStats()) {
+            compiler_.setLogSink(&std::cerr);
+        }
+
+        if(const auto cacheDir = options_->cacheDir(); !cacheDir.empty()) {
+            openCache(cacheDir);
+            if(const auto cached = cache_->load()) {
+                // the output is already known, so the grammar does not even have to be parsed
+                if(options_->printStats()) {
+                    std::cerr << "generation cache hit: " << cache_->key() << '\n';
+                }
+                writeOutput(*cached);
+                return true;
+            }
+        }
+
         return compile();
     }
 
@@ -143,6 +291,23 @@ private:
             return false;
         }
 
+        writeOutput(compiled.view());
+        if(cache_) {
+            if(options_->printStats()) {
+                std::cerr << "generation cache miss: " << cache_->key() << '\n';
+            }
+
+            // the output is already written, so failing to cache it is not an error
+            try {
+                cache_->store(compiled.view());
+            } catch(const std::exception& e) {
+                std::cerr << "warning: " << e.what() << '\n';
+            }
+        }
+        return true;
+    }
+
+    void writeOutput(std::string_view compiled) {
         output_.open(options_->outputFile());
         if(!output_.is_open()) {
             const auto msg = std::format(
@@ -151,8 +316,47 @@ private:
             );
             throw std::runtime_error(msg);
         }
-        output_ << compiled.str();
-        return true;
+        output_ << compiled;
+    }
+
+    void openCache(const std::string& cacheDir) {
+        const auto readAll = [](std::ifstream& file) {
+            if(!file.is_open()) {
+                return std::string();
+            }
+            auto text = std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+            file.clear();
+            file.seekg(0);
+            return text;
+        };
+
+        const auto input = readAll(input_);
+        const auto tmpl = readAll(tmpl_);
+
+        // builds of the same version can still generate different output, so the executable itself is part of the key
+        auto executable = std::ifstream(dll::program_location().string(), std::ios::binary);
+        const auto buildId = GenerationCache::makeKey(readAll(executable));
+
+        // the order of the options does not matter, except that a later definition of a name replaces the earlier one
+        std::map<std::string, std::string> sortedOptions;
+        for(const auto& [name, value] : options_->templateOptions()) {
+            sortedOptions[name] = value;
+        }
+
+        // the number of threads is left out, as it has no effect on the output
+        std::string templateOptions;
+        for(const auto& [name, value] : sortedOptions) {
+            templateOptions += std::format("{}={}\n", name, value);
+        }
+
+        cache_.emplace(cacheDir, std::initializer_list<std::string_view> {
+            parsec::Config::version(),
+            buildId,
+            options_->templateName(),
+            tmpl,
+            templateOptions,
+            input
+        });
     }
 
     void dumpError(const parsec::CompileError& err) {
@@ -202,6 +406,7 @@ private:
 
     const ParsecOptions* options_ = {};
     parsec::Compiler compiler_;
+    std::optional<GenerationCache> cache_;
 
     std::ifstream input_;
     std::ifstream tmpl_;
@@ -139,34 +139,49 @@ namespace parsec::regex {
 
 
     NodePtr Parser::parseCharSet() {
+        const auto negated = input_.skipIf('^');
+
         // empty character set
         if(input_.skipIf(']')) {
-            return empty();
+            return negated ? charSet(CharSet().set()) : empty();
         }
 
-        auto lhs = parseCharRange();
-        while(input_.peek() != ']') {
-            lhs = altern(lhs, parseCharRange());
-        }
+        CharSet chars;
+        do {
+            parseCharRange(chars);
+        } while(input_.peek() != ']');
         input_.skip(); // skip ']'
-        return lhs;
+
+        if(negated) {
+            chars.flip();
+        }
+
+        // a set of a single character is no different from the character itself
+        if(chars.count() == 1) {
+            for(int ch = 0; ch < static_cast<int>(chars.size()); ch++) {
+                if(chars.test(ch)) {
+                    return atomFromChar(static_cast<char>(ch));
+                }
+            }
+        }
+        return charSet(chars);
     }
 
 
-    NodePtr Parser::parseCharRange() {
+    void Parser::parseCharRange(CharSet& chars) {
         // save the position and value of the lower bound of the possible character range
         auto rngLoc = input_.pos();
-        const auto low = parseChar();
+        const auto low = text::toInt(parseChar());
 
         // no char range, just a single character
-        auto expr = atomFromChar(low);
         if(!input_.skipIf('-')) {
-            return expr;
+            chars.set(low);
+            return;
         }
 
         // string of the form 'l-h' is a character range
         if(input_.peek() != ']') {
-            const auto high = parseChar();
+            const auto high = text::toInt(parseChar());
             if(low > high) {
                 const auto& inputPos = input_.pos();
                 rngLoc.colCount = inputPos.offset - rngLoc.offset;
@@ -174,14 +189,13 @@ namespace parsec::regex {
                 throw ParseError::outOfOrderCharRange(rngLoc);
             }
 
-            for(auto ch = low + 1; ch <= high; ch++) {
-                expr = altern(expr, atomFromChar(static_cast<char>(ch)));
+            for(auto ch = low; ch <= high; ch++) {
+                chars.set(ch);
             }
         } else {
-            expr = altern(expr, atomFromChar('-'));
+            chars.set(low);
+            chars.set('-');
         }
-
-        return expr;
     }
 
 
@@ -9,6 +9,7 @@ export module parsec.regex:Parser;
 import parsec.scan;
 
 import :ast.ExprNode;
+import :ast.CharSetExprNode;
 
 namespace parsec::regex {
 
@@ -77,7 +78,7 @@ namespace parsec::regex {
         bool isAtom() const;
 
         NodePtr parseCharSet();
-        NodePtr parseCharRange();
+        void parseCharRange(CharSet& chars);
 
         char parseChar();
         char parseEscapeSeq();
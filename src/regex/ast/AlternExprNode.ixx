@@ -1,3 +1,7 @@
+module;
+
+#include <utility>
+
 export module parsec.regex:ast.AlternExprNode;
 
 import :ast.BinaryExprNode;
@@ -10,14 +14,19 @@ namespace parsec::regex {
     export class AlternExprNode : public BinaryExprNode {
     public:
 
-        using BinaryExprNode::BinaryExprNode;
+        AlternExprNode(NodePtr left, NodePtr right)
+            : BinaryExprNode(std::move(left), std::move(right)), nullable_(this->left()->isNullable() || this->right()->isNullable()) {}
 
 
         void accept(NodeVisitor& visitor) const override;
 
         bool isNullable() const noexcept override {
-            return left()->isNullable() || right()->isNullable();
+            return nullable_;
         }
+
+
+    private:
+        bool nullable_ = {};
     };
 
 }
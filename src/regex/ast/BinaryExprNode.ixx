@@ -15,10 +15,10 @@ namespace parsec::regex {
     public:
 
         BinaryExprNode(NodePtr left, NodePtr right)
-            : left_(std::move(left)), right_(std::move(right)) {}
+            : left_(std::move(left)), right_(std::move(right)), atomCount_(left_->atomCount() + right_->atomCount()) {}
 
         int atomCount() const noexcept override {
-            return left_->atomCount() + right_->atomCount();
+            return atomCount_;
         }
 
 
@@ -41,6 +41,7 @@ namespace parsec::regex {
     private:
         NodePtr left_;
         NodePtr right_;
+        int atomCount_ = {};
     };
 
 }
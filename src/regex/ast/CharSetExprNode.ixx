@@ -0,0 +1,51 @@
+module;
+
+#include <bitset>
+#include <utility>
+
+export module parsec.regex:ast.CharSetExprNode;
+
+import :ast.ExprNode;
+
+namespace parsec::regex {
+
+    /**
+     * @brief Set of 8-bit characters.
+     */
+    export using CharSet = std::bitset<256>;
+
+
+    /**
+     * @brief A basic expression matching any single character from a set.
+     */
+    export class CharSetExprNode : public ExprNode {
+    public:
+
+        explicit CharSetExprNode(CharSet chars)
+            : chars_(std::move(chars)) {}
+
+
+        void accept(NodeVisitor& visitor) const override;
+
+        bool isNullable() const noexcept override {
+            return false;
+        }
+
+        int atomCount() const noexcept override {
+            return 1;
+        }
+
+
+        /**
+         * @brief Characters matched by the expression.
+         */
+        const CharSet& chars() const noexcept {
+            return chars_;
+        }
+
+
+    private:
+        CharSet chars_;
+    };
+
+}
@@ -1,6 +1,7 @@
 export module parsec.regex:ast.NodeVisitor;
 
 export import :ast.AtomExprNode;
+export import :ast.CharSetExprNode;
 
 export import :ast.StarClosureNode;
 export import :ast.PlusClosureNode;
@@ -23,6 +24,12 @@ namespace parsec::regex {
         virtual void visit(const AtomExprNode& n) = 0;
 
 
+        /**
+         * @brief Called for a CharSetExprNode.
+         */
+        virtual void visit(const CharSetExprNode& n) = 0;
+
+
         /**
          * @brief Called for a StarClosureNode.
          */
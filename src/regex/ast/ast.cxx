@@ -28,6 +28,35 @@ namespace parsec::regex {
                 }
             }
 
+            void visit(const CharSetExprNode& n) override {
+                // sets with most of the characters are displayed as the complement of the remaining ones
+                const auto negated = n.chars().count() > n.chars().size() / 2;
+                const auto chars = negated ? ~n.chars() : n.chars();
+                const auto charCount = static_cast<int>(chars.size());
+
+                out_ << (negated ? "[^" : "[");
+                for(int first = 0; first < charCount; first++) {
+                    if(!chars.test(first)) {
+                        continue;
+                    }
+
+                    auto last = first;
+                    while(last + 1 < charCount && chars.test(last + 1)) {
+                        last++;
+                    }
+
+                    printSetChar(first);
+                    if(last - first > 1) {
+                        out_ << '-';
+                    }
+                    if(last != first) {
+                        printSetChar(last);
+                    }
+                    first = last;
+                }
+                out_ << ']';
+            }
+
             void visit(const OptionalExprNode& n) override {
                 n.inner()->accept(*this);
                 out_ << '?';
@@ -60,6 +89,23 @@ namespace parsec::regex {
             }
 
 
+            void printSetChar(int ch) {
+                switch(ch) {
+                    case '-':
+                    case '^':
+                    case ']':
+                    case '\\': {
+                        out_ << '\\' << static_cast<char>(ch);
+                        break;
+                    }
+                    default: {
+                        out_ << text::escape(static_cast<char>(ch));
+                        break;
+                    }
+                }
+            }
+
+
             std::ostream& out_;
         } impl(out);
         impl(n);
@@ -72,6 +118,10 @@ namespace parsec::regex {
         visitor.visit(*this);
     }
 
+    void CharSetExprNode::accept(NodeVisitor& visitor) const {
+        visitor.visit(*this);
+    }
+
     void StarClosureNode::accept(NodeVisitor& visitor) const {
         visitor.visit(*this);
     }
@@ -11,6 +11,7 @@ export import :ast.UnaryExprNode;
 export import :ast.BinaryExprNode;
 
 export import :ast.AtomExprNode;
+export import :ast.CharSetExprNode;
 
 export import :ast.AlternExprNode;
 export import :ast.ConcatExprNode;
@@ -41,6 +42,14 @@ namespace parsec::regex {
     }
 
 
+    /**
+     * @brief Create a CharSetExprNode.
+     */
+    export NodePtr charSet(CharSet chars) {
+        return std::make_shared<CharSetExprNode>(std::move(chars));
+    }
+
+
     /**
      * @brief Create an AlternExprNode.
      */
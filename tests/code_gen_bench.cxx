@@ -0,0 +1,158 @@
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <format>
+#include <new>
+#include <sstream>
+#include <streambuf>
+#include <string>
+
+#include "grammars.hpp"
+
+import parsec;
+import parsec.bnf;
+
+using namespace parsec;
+
+
+namespace {
+    constexpr auto Tags = "[.][benchmark][codegen]";
+
+    // every allocation is prefixed with its size, so that the bytes in use are known when it is freed
+    constexpr std::size_t AllocHeaderSize = alignof(std::max_align_t);
+
+    std::atomic<std::size_t> heapInUse = 0;
+    std::atomic<std::size_t> heapPeak = 0;
+
+
+    /**
+     * @brief Discards the output while counting its size, so that the output does not add to the heap usage.
+     */
+    class CountingBuffer : public std::streambuf {
+    public:
+
+        std::size_t size() const noexcept {
+            return size_;
+        }
+
+    protected:
+        int_type overflow(int_type ch) override {
+            size_++;
+            return traits_type::not_eof(ch);
+        }
+
+        std::streamsize xsputn(const char_type*, std::streamsize count) override {
+            size_ += static_cast<std::size_t>(count);
+            return count;
+        }
+
+    private:
+        std::size_t size_ = 0;
+    };
+
+    bnf::SymbolGrammar makeOperatorTokens(int count) {
+        bnf::SymbolGrammar tokens;
+        tokens.define("id", bnf::RegularExpr("[a-z]+"))
+            .define("num", bnf::RegularExpr("[0-9]+"))
+            .define("lp", bnf::RegularExpr("<"))
+            .define("rp", bnf::RegularExpr(">"));
+        for(int i = 0; i < count; i++) {
+            tokens.define(std::format("op{}", i), bnf::RegularExpr(std::format("o{}", i)));
+        }
+        return tokens;
+    }
+
+
+    std::size_t generate(const bnf::SymbolGrammar& tokens, const bnf::SymbolGrammar& rules, const std::string* tmpl) {
+        CountingBuffer buffer;
+        std::ostream output(&buffer);
+        std::istringstream tmplInput(tmpl ? *tmpl : "");
+
+        CodeGen gen;
+        gen.setTokenGrammar(&tokens);
+        gen.setRuleGrammar(&rules);
+        gen.setOutputSink(&output);
+        if(tmpl) {
+            gen.setOutputTemplateSource(&tmplInput);
+        }
+        gen.generate();
+        return buffer.size();
+    }
+
+
+    std::size_t measurePeakHeap(const bnf::SymbolGrammar& tokens, const bnf::SymbolGrammar& rules, const std::string* tmpl) {
+        const auto start = heapInUse.load();
+        heapPeak = start;
+        generate(tokens, rules, tmpl);
+        return heapPeak.load() - start;
+    }
+}
+
+
+void* operator new(std::size_t size) {
+    auto* const block = static_cast<std::byte*>(std::malloc(size + AllocHeaderSize));
+    if(!block) {
+        throw std::bad_alloc();
+    }
+    *reinterpret_cast<std::size_t*>(block) = size;
+
+    const auto inUse = heapInUse.fetch_add(size, std::memory_order_relaxed) + size;
+    auto peak = heapPeak.load(std::memory_order_relaxed);
+    while(inUse > peak && !heapPeak.compare_exchange_weak(peak, inUse, std::memory_order_relaxed)) {}
+
+    return block + AllocHeaderSize;
+}
+
+
+void operator delete(void* ptr) noexcept {
+    if(!ptr) {
+        return;
+    }
+    auto* const block = static_cast<std::byte*>(ptr) - AllocHeaderSize;
+    heapInUse.fetch_sub(*reinterpret_cast<std::size_t*>(block), std::memory_order_relaxed);
+    std::free(block);
+}
+
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    operator delete(ptr);
+}
+
+
+TEST_CASE("generating output for large grammars", Tags) {
+    // a template touching the parser states needs them gathered into a single document
+    const auto tmpl = std::string("{{ length(parse_states) }}");
+
+    for(const auto depth : { 50, 200 }) {
+        const auto tokens = makeOperatorTokens(depth);
+        const auto rules = makePrecedenceChain(depth);
+
+        BENCHMARK(std::format("JSON output for a chain of {} rules", depth)) {
+            return generate(tokens, rules, nullptr);
+        };
+
+        BENCHMARK(std::format("template output for a chain of {} rules", depth)) {
+            return generate(tokens, rules, &tmpl);
+        };
+    }
+}
+
+
+TEST_CASE("peak heap usage of generating output for large grammars", Tags) {
+    const auto tmpl = std::string("{{ length(parse_states) }}");
+
+    for(const auto depth : { 50, 200 }) {
+        const auto tokens = makeOperatorTokens(depth);
+        const auto rules = makePrecedenceChain(depth);
+
+        const auto jsonPeak = measurePeakHeap(tokens, rules, nullptr);
+        const auto tmplPeak = measurePeakHeap(tokens, rules, &tmpl);
+        WARN(std::format(
+            "peak heap for a chain of {} rules: {} KiB with JSON output, {} KiB with template output",
+            depth, jsonPeak / 1024, tmplPeak / 1024
+        ));
+    }
+}
@@ -0,0 +1,151 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <map>
+#include <string>
+#include <vector>
+
+import parsec.fsm;
+import parsec.bnf;
+
+using namespace parsec::fsm;
+using namespace parsec::bnf;
+
+
+namespace {
+    constexpr auto Tags = "[fsm][minimize]";
+
+
+    class Automaton : public DfaStateGen::StateSink {
+    public:
+
+        std::string match(const std::string& input) const {
+            int state = 0;
+            for(const auto ch : input) {
+                const auto& transitions = states_.at(state).transitions;
+                const auto transIt = transitions.find(std::string(1, ch));
+                if(transIt == transitions.end()) {
+                    return "";
+                }
+                state = transIt->second;
+            }
+            return states_.at(state).match;
+        }
+
+        int stateCount() const {
+            return static_cast<int>(states_.size());
+        }
+
+        int rangeCount() const {
+            return rangeCount_;
+        }
+
+    private:
+        void addState(int id) override {
+            states_.resize(id + 1);
+        }
+
+        void addStateTransition(int state, int target, const Symbol& label) override {
+            states_[state].transitions[label.text()] = target;
+        }
+
+        void addStateRangeTransition(int state, int target, int first, int last) override {
+            rangeCount_++;
+            StateSink::addStateRangeTransition(state, target, first, last);
+        }
+
+        void setStateMatch(int state, const Symbol& match) override {
+            states_[state].match = match.text();
+        }
+
+        struct State {
+            std::map<std::string, int> transitions;
+            std::string match;
+        };
+
+        std::vector<State> states_;
+        int rangeCount_ = 0;
+    };
+
+
+    Automaton minimize(const SymbolGrammar& grammar, DfaMinimizer& minimizer) {
+        Automaton automaton;
+        minimizer.setStateSink(&automaton);
+        DfaStateGen()
+            .setInputGrammar(&grammar)
+            .setStateSink(&minimizer)
+            .generate();
+        minimizer.flush();
+        return automaton;
+    }
+}
+
+
+TEST_CASE("minimization merges states with equivalent futures", Tags) {
+    const auto grammar = SymbolGrammar().define("A", RegularExpr("ab|cb"));
+
+    DfaMinimizer minimizer;
+    const auto automaton = minimize(grammar, minimizer);
+
+    CHECK(minimizer.inputStateCount() == 4);
+    CHECK(minimizer.outputStateCount() == 3);
+    CHECK(automaton.stateCount() == 3);
+
+    CHECK(automaton.match("ab") == "A");
+    CHECK(automaton.match("cb") == "A");
+    CHECK(automaton.match("a").empty());
+    CHECK(automaton.match("ac").empty());
+}
+
+TEST_CASE("minimization keeps states matching different symbols apart", Tags) {
+    const auto grammar = SymbolGrammar()
+                             .define("A", RegularExpr("ab"))
+                             .define("B", RegularExpr("cb"));
+
+    DfaMinimizer minimizer;
+    const auto automaton = minimize(grammar, minimizer);
+
+    CHECK(minimizer.inputStateCount() == 5);
+    CHECK(minimizer.outputStateCount() == 5);
+
+    CHECK(automaton.match("ab") == "A");
+    CHECK(automaton.match("cb") == "B");
+}
+
+TEST_CASE("minimization of looping states", Tags) {
+    const auto grammar = SymbolGrammar().define("A", RegularExpr("a(a|b)*|b(a|b)*"));
+
+    DfaMinimizer minimizer;
+    const auto automaton = minimize(grammar, minimizer);
+
+    CHECK(minimizer.outputStateCount() == 2);
+
+    CHECK(automaton.match("a") == "A");
+    CHECK(automaton.match("babba") == "A");
+    CHECK(automaton.match("").empty());
+}
+
+TEST_CASE("minimization of an empty automaton", Tags) {
+    DfaMinimizer minimizer;
+    const auto automaton = minimize(SymbolGrammar(), minimizer);
+
+    CHECK(minimizer.inputStateCount() == 0);
+    CHECK(minimizer.outputStateCount() == 0);
+    CHECK(automaton.stateCount() == 0);
+}
+
+TEST_CASE("minimization reports consecutive characters with the same target as ranges", Tags) {
+    const auto grammar = SymbolGrammar()
+                             .define("A", RegularExpr("[a-z]+"))
+                             .define("B", RegularExpr("[02]"));
+
+    DfaMinimizer minimizer;
+    const auto automaton = minimize(grammar, minimizer);
+
+    // one range out of the start state and one on the loop, "0" and "2" are not adjacent
+    CHECK(automaton.rangeCount() == 2);
+
+    CHECK(automaton.match("abz") == "A");
+    CHECK(automaton.match("0") == "B");
+    CHECK(automaton.match("2") == "B");
+    CHECK(automaton.match("1").empty());
+}
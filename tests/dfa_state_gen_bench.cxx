@@ -0,0 +1,54 @@
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <format>
+#include <random>
+#include <set>
+#include <string>
+
+import parsec.bnf;
+import parsec.fsm;
+
+using namespace parsec;
+
+
+namespace {
+    constexpr auto Tags = "[.][benchmark][fsm]";
+
+    bnf::SymbolGrammar makeTokens(int count) {
+        // random words of varying length make for a token automaton with few shared prefixes and many states
+        std::mt19937 random(count);
+        std::uniform_int_distribution<int> length(4, 12);
+        std::uniform_int_distribution<int> letter('a', 'z');
+
+        std::set<std::string> words;
+        while(static_cast<int>(words.size()) < count) {
+            std::string word(length(random), ' ');
+            for(auto& ch : word) {
+                ch = static_cast<char>(letter(random));
+            }
+            words.insert(std::move(word));
+        }
+
+        bnf::SymbolGrammar tokens;
+        for(int index = 0; const auto& word : words) {
+            tokens.define(std::format("t{}", index++), bnf::RegularExpr(word));
+        }
+        return tokens;
+    }
+}
+
+
+TEST_CASE("generating states for large token sets", Tags) {
+    for(const auto count : { 1000, 10000, 30000 }) {
+        const auto tokens = makeTokens(count);
+        for(const auto threadCount : { 1, 2, 4 }) {
+            BENCHMARK(std::format("{} tokens on {} threads", count, threadCount)) {
+                fsm::DfaStateGen()
+                    .setInputGrammar(&tokens)
+                    .setThreadCount(threadCount)
+                    .generate();
+            };
+        }
+    }
+}
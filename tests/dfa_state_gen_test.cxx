@@ -0,0 +1,76 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <format>
+#include <string>
+#include <vector>
+
+import parsec.fsm;
+import parsec.bnf;
+
+using namespace parsec::fsm;
+using namespace parsec::bnf;
+
+
+namespace {
+    constexpr auto Tags = "[fsm][dfa]";
+
+
+    class StateLog : public DfaStateGen::StateSink {
+    public:
+
+        const std::vector<std::string>& entries() const noexcept {
+            return entries_;
+        }
+
+    private:
+        void addState(int id) override {
+            entries_.push_back(std::format("state {}", id));
+        }
+
+        void addStateTransition(int state, int target, const Symbol& label) override {
+            entries_.push_back(std::format("{} -{}-> {}", state, label.text(), target));
+        }
+
+        void setStateMatch(int state, const Symbol& match) override {
+            entries_.push_back(std::format("{} matches {}", state, match.text()));
+        }
+
+        std::vector<std::string> entries_;
+    };
+
+
+    std::vector<std::string> generate(const SymbolGrammar& grammar, int threadCount) {
+        StateLog log;
+        DfaStateGen()
+            .setInputGrammar(&grammar)
+            .setStateSink(&log)
+            .setThreadCount(threadCount)
+            .generate();
+        return log.entries();
+    }
+}
+
+
+TEST_CASE("DFA states are numbered the same regardless of the number of threads", Tags) {
+    const auto grammar = SymbolGrammar()
+                             .define("Id", RegularExpr("[a-z_][a-z0-9_]*"))
+                             .define("Num", RegularExpr("[0-9]+(.[0-9]+)?"))
+                             .define("Arrow", RegularExpr("->"))
+                             .define("Minus", RegularExpr("-"))
+                             .define("Str", RegularExpr("\"([^\"\\\\]|\\\\.)*\""));
+
+    const auto sequential = generate(grammar, 1);
+    REQUIRE_FALSE(sequential.empty());
+
+    CHECK(generate(grammar, 2) == sequential);
+    CHECK(generate(grammar, 8) == sequential);
+}
+
+TEST_CASE("concurrent state generation reports conflicting symbols", Tags) {
+    const auto grammar = SymbolGrammar()
+                             .define("A", RegularExpr("ab"))
+                             .define("B", RegularExpr("a[bc]"));
+
+    CHECK_THROWS_AS(generate(grammar, 1), NameConflictError);
+    CHECK_THROWS_AS(generate(grammar, 4), NameConflictError);
+}
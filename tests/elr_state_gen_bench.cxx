@@ -0,0 +1,29 @@
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <format>
+#include <string>
+
+#include "grammars.hpp"
+
+import parsec.bnf;
+import parsec.fsm;
+
+using namespace parsec;
+
+
+namespace {
+    constexpr auto Tags = "[.][benchmark][fsm]";
+}
+
+
+TEST_CASE("generating states for deep chains of rules", Tags) {
+    for(const auto depth : { 50, 200, 800 }) {
+        const auto rules = makePrecedenceChain(depth);
+        BENCHMARK(std::format("chain of {} rules", depth)) {
+            fsm::ElrStateGen gen;
+            gen.setInputGrammar(&rules).generate();
+            return gen.dfaOutputStateCount();
+        };
+    }
+}
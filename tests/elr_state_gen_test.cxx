@@ -0,0 +1,79 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <format>
+#include <string>
+#include <vector>
+
+import parsec.fsm;
+import parsec.bnf;
+
+using namespace parsec::fsm;
+using namespace parsec::bnf;
+
+
+namespace {
+    constexpr auto Tags = "[fsm][elr]";
+
+
+    class StateLog : public ElrStateGen::StateSink {
+    public:
+
+        const std::vector<std::string>& entries() const noexcept {
+            return entries_;
+        }
+
+    private:
+        void addState(int id) override {
+            entries_.push_back(std::format("state {}", id));
+        }
+
+        void addStateTokenTransition(int state, int target, const Symbol& label) override {
+            entries_.push_back(std::format("{} -{}-> {}", state, label.text(), target));
+        }
+
+        void addStateRuleTransition(int state, int target, const Symbol& label) override {
+            entries_.push_back(std::format("{} ={}=> {}", state, label.text(), target));
+        }
+
+        void addStateBacklink(int state, int backlink) override {
+            entries_.push_back(std::format("{} backlink {}", state, backlink));
+        }
+
+        void setActiveBacklink(int state, int backlink) override {
+            entries_.push_back(std::format("{} active backlink {}", state, backlink));
+        }
+
+        void setStateMatch(int state, const Symbol& match) override {
+            entries_.push_back(std::format("{} matches {}", state, match.text()));
+        }
+
+        std::vector<std::string> entries_;
+    };
+
+
+    std::vector<std::string> generate(const SymbolGrammar& grammar, int threadCount) {
+        StateLog log;
+        ElrStateGen()
+            .setInputGrammar(&grammar)
+            .setStateSink(&log)
+            .setThreadCount(threadCount)
+            .generate();
+        return log.entries();
+    }
+}
+
+
+TEST_CASE("state generation does not depend on the number of threads", Tags) {
+    const auto grammar = SymbolGrammar()
+                             .define("S", RegularExpr("(A|B)*C"))
+                             .define("A", RegularExpr("a(b|c)*"))
+                             .define("B", RegularExpr("bA?"))
+                             .define("C", RegularExpr("c|dS"))
+                             .setRoot("S");
+
+    const auto sequential = generate(grammar, 1);
+    REQUIRE_FALSE(sequential.empty());
+
+    CHECK(generate(grammar, 2) == sequential);
+    CHECK(generate(grammar, 8) == sequential);
+}
@@ -0,0 +1,182 @@
+#include "ExprParser.hpp"
+
+#include <charconv>
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+/*
+ * Evaluates expressions with the calculator example generated with one of the combinations of template options,
+ * the options that change the interface of the parser are passed in as EXPR_PARSER_* definitions.
+ */
+namespace {
+#if defined(EXPR_PARSER_STATIC_HOOKS)
+    class ExprEvaluator : public Parser<ExprEvaluator> {
+        friend Parser<ExprEvaluator>;
+#else
+    class ExprEvaluator : public Parser {
+#endif
+    public:
+        using Parser::Parser;
+
+        double result() const noexcept {
+            return result_;
+        }
+
+    private:
+        void onRootExpr(std::span<const Token> /*tokens*/, std::span<SemanticValue> values) {
+            result_ = valueOf<ParseRules::Expr>(values.front());
+        }
+
+        double onExpr(std::span<const Token> tokens, std::span<SemanticValue> values) {
+            if(tokens.empty()) {
+                return valueOf<ParseRules::Term>(values.front());
+            }
+            return evalBinary(valueOf<ParseRules::Expr>(values[0]), tokens.front().kind(), valueOf<ParseRules::Term>(values[1]));
+        }
+
+        double onTerm(std::span<const Token> tokens, std::span<SemanticValue> values) {
+            if(tokens.empty()) {
+                return valueOf<ParseRules::Factor>(values.front());
+            }
+            return evalBinary(valueOf<ParseRules::Term>(values[0]), tokens.front().kind(), valueOf<ParseRules::Factor>(values[1]));
+        }
+
+        double onFactor(std::span<const Token> tokens, std::span<SemanticValue> values) {
+            if(tokens.front().kind() != TokenKinds::Number) {
+                return valueOf<ParseRules::Expr>(values.front());
+            }
+
+            const auto text = tokens.front().text();
+
+            double value = 0;
+            std::from_chars(text.data(), text.data() + text.size(), value);
+            return value;
+        }
+
+
+        static double evalBinary(double lhs, TokenKinds op, double rhs) {
+            switch(op) {
+                case TokenKinds::AddOp: return lhs + rhs;
+                case TokenKinds::SubOp: return lhs - rhs;
+                case TokenKinds::MulOp: return lhs * rhs;
+                case TokenKinds::DivOp: return lhs / rhs;
+                default:                return 0;
+            }
+        }
+
+
+        double result_ = 0;
+    };
+
+
+    template <typename Step>
+    bool succeeds(Step&& step) {
+#if defined(EXPR_PARSER_EXPECTED)
+        return step().has_value();
+#else
+        try {
+            step();
+            return true;
+        } catch(const ParseError&) {
+            return false;
+        }
+#endif
+    }
+
+
+    std::optional<double> evaluate(std::string_view expr) {
+#if defined(EXPR_PARSER_MAPPED_FILE)
+        // the file is left behind in the working directory of the test
+        std::ofstream("input.txt", std::ios::binary) << expr;
+#  if defined(EXPR_PARSER_EXPECTED)
+        const auto file = MappedFile::open("input.txt");
+        if(!file) {
+            return std::nullopt;
+        }
+        ExprEvaluator evaluator(*file);
+#  else
+        const auto file = MappedFile::open("input.txt");
+        ExprEvaluator evaluator(file);
+#  endif
+#elif defined(EXPR_PARSER_BUFFER)
+        ExprEvaluator evaluator(expr);
+#elif defined(EXPR_PARSER_PUSH)
+        ExprEvaluator evaluator;
+#else
+        auto input = std::istringstream(std::string(expr));
+        ExprEvaluator evaluator(&input);
+#endif
+
+#if defined(EXPR_PARSER_PUSH)
+        // feed the input two bytes at a time, so that tokens are split between the chunks
+        for(std::size_t pos = 0; pos < expr.size(); pos += 2) {
+            if(!succeeds([&] { return evaluator.feed(expr.substr(pos, 2)); })) {
+                return std::nullopt;
+            }
+        }
+
+        if(!succeeds([&] { return evaluator.finish(); })) {
+            return std::nullopt;
+        }
+
+        // the parse is over once the input is accepted, so an accepted input reports an error if anything follows it
+        if(succeeds([&] { return evaluator.feed(expr); })) {
+            return std::nullopt;
+        }
+#else
+        if(!succeeds([&] { return evaluator.parse(); })) {
+            return std::nullopt;
+        }
+#endif
+        return evaluator.result();
+    }
+}
+
+
+int main() {
+    const struct {
+        std::string_view expr;
+        std::optional<double> result;
+    } cases[] = {
+        {  "1+2*(3-1)/4",            2 },
+        { "(1.5+2.5)*10",           40 },
+        {        "7/2-1",          2.5 },
+        {      "(((1)))",            1 },
+        {    " 8 / 2 / 2",            2 },
+        {           "2*", std::nullopt },
+        {          "1 2", std::nullopt },
+        {         "(1+2", std::nullopt },
+        {            "a", std::nullopt },
+    };
+
+    int failureCount = 0;
+    for(const auto& [expr, expected] : cases) {
+        if(const auto result = evaluate(expr); result != expected) {
+            std::cerr << "\"" << expr << "\" evaluated to ";
+            if(result) {
+                std::cerr << *result;
+            } else {
+                std::cerr << "an error";
+            }
+            std::cerr << '\n';
+            failureCount++;
+        }
+    }
+
+#if defined(EXPR_PARSER_TABLE_PARSER)
+    // the table parser keeps its states on a stack of its own, so the nesting depth is not limited by the call stack
+    constexpr std::size_t NestingDepth = 100'000;
+    const auto nested = std::string(NestingDepth, '(') + "1" + std::string(NestingDepth, ')');
+    if(evaluate(nested) != 1) {
+        std::cerr << NestingDepth << " nested parentheses did not evaluate to 1\n";
+        failureCount++;
+    }
+#endif
+    return failureCount == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
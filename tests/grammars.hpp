@@ -0,0 +1,31 @@
+#pragma once
+
+#include <format>
+
+import parsec.bnf;
+import parsec.regex;
+
+
+/**
+ * @brief Make an expression grammar with one rule per precedence level, each entering the next one.
+ * @details Results in a large number of parser states, with rules named @c e0 to @c e{depth} over the tokens
+ *      @c id, @c num, @c lp, @c rp and @c op0 to @c op{depth-1}.
+ */
+inline parsec::bnf::SymbolGrammar makePrecedenceChain(int depth) {
+    using namespace parsec;
+
+    bnf::SymbolGrammar rules;
+    for(int i = 0; i < depth; i++) {
+        const auto next = regex::atom(std::format("e{}", i + 1));
+        const auto op = regex::atom(std::format("op{}", i));
+        rules.define(std::format("e{}", i), bnf::RegularExpr(regex::concat(next, regex::starClosure(regex::concat(op, next)))));
+    }
+
+    const auto primary = regex::altern(
+        regex::altern(regex::atom("id"), regex::atom("num")),
+        regex::concat(regex::concat(regex::atom("lp"), regex::atom("e0")), regex::atom("rp"))
+    );
+    rules.define(std::format("e{}", depth), bnf::RegularExpr(primary));
+    rules.setRoot("e0");
+    return rules;
+}
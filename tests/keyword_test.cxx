@@ -0,0 +1,131 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <regex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "CppKeywordsGoto.hpp"
+#include "CppKeywordsTable.hpp"
+
+import parsec;
+
+namespace {
+    constexpr auto Tags = "[lexer][keywords]";
+
+
+    template <typename Lexer, typename TokenKinds>
+    std::vector<std::string> lexKinds(std::string_view input) {
+        std::vector<std::string> kinds;
+        for(auto lexer = Lexer(input); lexer.peek().kind() != TokenKinds::Eof;) {
+            std::ostringstream out;
+            out << lexer.lex().kind();
+            kinds.push_back(out.str());
+        }
+        return kinds;
+    }
+
+
+    std::vector<std::string> checkSameKinds(std::string_view input) {
+        const auto gotoKinds = lexKinds<goto_keywords::Lexer, goto_keywords::TokenKinds>(input);
+        const auto tableKinds = lexKinds<table_keywords::Lexer, table_keywords::TokenKinds>(input);
+
+        CAPTURE(input);
+        CHECK(gotoKinds == tableKinds);
+        return gotoKinds;
+    }
+
+
+    std::string readGrammar() {
+        std::ifstream input(CPP_KEYWORDS_GRAMMAR);
+        return std::string(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+    }
+
+
+    std::string compileToJson(const std::string& grammar) {
+        std::istringstream input(grammar);
+        std::ostringstream output;
+
+        parsec::Compiler compiler;
+        compiler.setInputSource(&input);
+        compiler.setOutputSink(&output);
+        compiler.compile();
+        return output.str();
+    }
+
+
+    std::uint64_t readJsonNumber(const std::string& json, const std::string& key) {
+        std::smatch match;
+        REQUIRE(std::regex_search(json, match, std::regex("\"" + key + "\": ([0-9]+)")));
+        return std::stoull(match[1]);
+    }
+
+
+    std::uint64_t keywordSlot(std::string_view text, std::uint64_t seed, std::uint64_t shift) {
+        // the hash function of the generated lexer
+        auto hash = seed ^ 0xcbf29ce484222325;
+        for(const auto ch : text) {
+            hash = (hash ^ static_cast<unsigned char>(ch)) * 0x100000001b3;
+        }
+        return (hash * 0x9e3779b97f4a7c15) >> shift;
+    }
+}
+
+
+TEST_CASE("keywords are only recognized if the whole identifier matches them", Tags) {
+    CHECK(checkSameKinds("if ifx i") == std::vector<std::string>{ "KwIf", "Ident", "Ident" });
+    CHECK(checkSameKinds("while whil whiles") == std::vector<std::string>{ "KwWhile", "Ident", "Ident" });
+    CHECK(checkSameKinds("char8_t char8 co_await co_ static_assert2") == std::vector<std::string>{
+        "KwChar8T", "Ident", "KwCoAwait", "Ident", "Ident"
+    });
+    CHECK(checkSameKinds("If IF _if 1if") == std::vector<std::string>{ "Ident", "Ident", "Ident", "Number", "KwIf" });
+}
+
+
+TEST_CASE("identifiers hashing to the slot of a keyword are not taken for it", Tags) {
+    const auto grammar = readGrammar();
+    REQUIRE_FALSE(grammar.empty());
+
+    const auto json = compileToJson(grammar);
+    const auto seed = readJsonNumber(json, "seed");
+    const auto shift = readJsonNumber(json, "shift");
+
+    std::set<std::string> keywords;
+    std::set<std::uint64_t> keywordSlots;
+    const auto literal = std::regex("'([a-z0-9_]+)'");
+    for(auto it = std::sregex_iterator(grammar.begin(), grammar.end(), literal); it != std::sregex_iterator(); ++it) {
+        keywords.insert((*it)[1]);
+        keywordSlots.insert(keywordSlot((*it)[1].str(), seed, shift));
+    }
+    REQUIRE(keywords.size() == 81);
+
+    // two-letter identifiers are more than enough to land in some of the occupied slots
+    std::optional<std::string> collision;
+    for(char first = 'a'; first <= 'z' && !collision; first++) {
+        for(char second = 'a'; second <= 'z' && !collision; second++) {
+            const auto text = std::string{ first, second };
+            if(!keywords.contains(text) && keywordSlots.contains(keywordSlot(text, seed, shift))) {
+                collision = text;
+            }
+        }
+    }
+    REQUIRE(collision);
+
+    CAPTURE(*collision);
+    CHECK(checkSameKinds(*collision) == std::vector<std::string>{ "Ident" });
+}
+
+
+TEST_CASE("a literal matched by several tokens is reported as a conflict", Tags) {
+    CHECK_THROWS_AS(compileToJson(R"(tokens {
+        lower = "[a-z]+";
+        name = "[a-z][a-z0-9]*";
+        kw-if = 'if';
+    })"), parsec::CompileError);
+}
@@ -0,0 +1,30 @@
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <string>
+
+#include "CppLexerGoto.hpp"
+#include "CppLexerTable.hpp"
+#include "sources.hpp"
+
+
+namespace {
+    constexpr auto Tags = "[.][benchmark][lexer]";
+}
+
+
+TEST_CASE("lexing a large input with the goto and table lexer backends", Tags) {
+    const auto source = makeCppSource(std::size_t(16) << 20);
+
+    BENCHMARK("goto backend") {
+        auto tokens = goto_backend::TokenBuffer();
+        goto_backend::Lexer(source).lexAll(tokens);
+        return tokens.size();
+    };
+
+    BENCHMARK("table backend") {
+        auto tokens = table_backend::TokenBuffer();
+        table_backend::Lexer(source).lexAll(tokens);
+        return tokens.size();
+    };
+}
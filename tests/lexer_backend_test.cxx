@@ -0,0 +1,60 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "CppLexerGoto.hpp"
+#include "CppLexerTable.hpp"
+#include "sources.hpp"
+
+
+namespace {
+    constexpr auto Tags = "[lexer]";
+
+
+    template <typename Lexer, typename TokenBuffer, typename ParseError>
+    std::optional<std::int64_t> lexAll(std::string_view input, TokenBuffer& tokens) {
+        // the offset of the malformed token, if there is one
+        try {
+            Lexer(input).lexAll(tokens);
+            return std::nullopt;
+        } catch(const ParseError& e) {
+            return e.loc().offset;
+        }
+    }
+
+
+    std::optional<std::int64_t> checkSameTokens(std::string_view input) {
+        auto gotoTokens = goto_backend::TokenBuffer();
+        const auto gotoError = lexAll<goto_backend::Lexer, goto_backend::TokenBuffer, goto_backend::ParseError>(input, gotoTokens);
+
+        auto tableTokens = table_backend::TokenBuffer();
+        const auto tableError = lexAll<table_backend::Lexer, table_backend::TokenBuffer, table_backend::ParseError>(input, tableTokens);
+
+        CAPTURE(input);
+        CHECK(gotoError == tableError);
+
+        // the token kinds of both lexers are enumerated in the same order
+        const auto toInt = [](auto kind) { return static_cast<int>(kind); };
+        CHECK(std::ranges::equal(gotoTokens.kinds(), tableTokens.kinds(), {}, toInt, toInt));
+        CHECK(std::ranges::equal(gotoTokens.offsets(), tableTokens.offsets()));
+        CHECK(std::ranges::equal(gotoTokens.lengths(), tableTokens.lengths()));
+        return gotoError;
+    }
+}
+
+
+TEST_CASE("the goto and table lexer backends produce the same tokens", Tags) {
+    CHECK_FALSE(checkSameTokens(makeCppSource(1 << 16)));
+    CHECK_FALSE(checkSameTokens("a <<= b >> c; d != e && !f || g;"));
+}
+
+
+TEST_CASE("the goto and table lexer backends fail on the same malformed tokens", Tags) {
+    CHECK(checkSameTokens("value = 1 $ 2;") == 10);
+    CHECK(checkSameTokens("value = 1.5 @") == 12);
+    CHECK(checkSameTokens("`") == 0);
+}
@@ -0,0 +1,137 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdint>
+#include <fstream>
+#include <optional>
+#include <span>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "CppOperatorsBuffer.hpp"
+#include "CppOperatorsMappedFile.hpp"
+#include "CppOperatorsPush.hpp"
+#include "CppOperatorsStream.hpp"
+
+
+namespace {
+    constexpr auto Tags = "[lexer][literal-chain]";
+
+
+    struct LexResult {
+        std::vector<std::string> tokens;
+        std::optional<std::int64_t> error;
+
+        bool operator==(const LexResult&) const = default;
+    };
+
+
+    template <typename Token>
+    std::string describe(const Token& tok) {
+        std::ostringstream out;
+        out << tok;
+        return out.str();
+    }
+
+
+    template <typename ParseError, typename Lexer>
+    LexResult lexAll(Lexer& lexer) {
+        LexResult result;
+        try {
+            for(auto tok = lexer.lex(); describe(tok.kind()) != "Eof"; tok = lexer.lex()) {
+                result.tokens.push_back(describe(tok));
+            }
+        } catch(const ParseError& e) {
+            result.error = e.loc().offset;
+        }
+        return result;
+    }
+
+
+    LexResult lexStream(std::string_view input) {
+        auto stream = std::istringstream(std::string(input));
+        auto lexer = stream_input::Lexer(&stream);
+        return lexAll<stream_input::ParseError>(lexer);
+    }
+
+
+    LexResult lexBuffer(std::string_view input) {
+        auto lexer = buffer_input::Lexer(input);
+        return lexAll<buffer_input::ParseError>(lexer);
+    }
+
+
+    LexResult lexMappedFile(std::string_view input) {
+        // the file is left behind in the working directory of the test
+        std::ofstream("literal_chain_input.txt", std::ios::binary) << input;
+
+        const auto file = mapped_file_input::MappedFile::open("literal_chain_input.txt");
+        auto lexer = mapped_file_input::Lexer(file);
+        return lexAll<mapped_file_input::ParseError>(lexer);
+    }
+
+
+    LexResult lexPush(std::string_view input) {
+        LexResult result;
+        auto lexer = push_input::Lexer();
+
+        const auto lexAvailable = [&] {
+            while(const auto* const tok = lexer.peek()) {
+                if(describe(tok->kind()) == "Eof") {
+                    return;
+                }
+                result.tokens.push_back(describe(lexer.lex()));
+            }
+        };
+
+        try {
+            // a single byte at a time, so that every literal is split between the chunks
+            for(std::size_t pos = 0; pos < input.size(); pos++) {
+                lexer.feed(std::span(input.data() + pos, 1));
+                lexAvailable();
+            }
+            lexer.finish();
+            lexAvailable();
+        } catch(const push_input::ParseError& e) {
+            result.error = e.loc().offset;
+        }
+        return result;
+    }
+
+
+    LexResult checkSameResults(std::string_view input) {
+        // the stream lexer follows the automaton byte by byte, without comparing literals at once
+        const auto expected = lexStream(input);
+
+        CAPTURE(input);
+        CHECK(lexBuffer(input) == expected);
+        CHECK(lexMappedFile(input) == expected);
+        CHECK(lexPush(input) == expected);
+        return expected;
+    }
+}
+
+
+TEST_CASE("literals with shared prefixes are lexed the same for all inputs", Tags) {
+    CHECK(checkSameResults("a->*b->c-d...e") == LexResult{
+        .tokens = {
+            R"((Ident: "a"))", R"((ArrowStar: "->*"))", R"((Ident: "b"))", R"((Arrow: "->"))",
+            R"((Ident: "c"))", R"((Minus: "-"))", R"((Ident: "d"))", R"((Ellipsis: "..."))", R"((Ident: "e"))"
+        }
+    });
+
+    checkSameResults("x <=> y - -> ->* ...");
+    checkSameResults("...<=>...-->-");
+    checkSameResults("--->*->->*");
+}
+
+
+TEST_CASE("literals cut short fail at the same position for all inputs", Tags) {
+    CHECK(checkSameResults("a .. b").error == 2);
+    CHECK(checkSameResults("a..").error == 1);
+    CHECK(checkSameResults("x <= y").error == 2);
+    CHECK(checkSameResults("<").error == 0);
+    CHECK(checkSameResults("->.").error == 2);
+    CHECK(checkSameResults("....").error == 3);
+}
@@ -0,0 +1,32 @@
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <format>
+#include <string>
+
+#include "CppLexer.hpp"
+#include "sources.hpp"
+
+
+namespace {
+    constexpr auto Tags = "[.][benchmark][lexer]";
+}
+
+
+TEST_CASE("lexing a large input with a growing number of threads", Tags) {
+    const auto source = makeCppSource(std::size_t(16) << 20);
+
+    BENCHMARK("sequential lexAll()") {
+        auto tokens = TokenBuffer();
+        Lexer(source).lexAll(tokens);
+        return tokens.size();
+    };
+
+    for(const auto threads : { 1u, 2u, 4u, 8u, 16u }) {
+        BENCHMARK(std::format("lexAllParallel() with {} threads", threads)) {
+            auto tokens = TokenBuffer();
+            Lexer(source).lexAllParallel(tokens, threads);
+            return tokens.size();
+        };
+    }
+}
@@ -0,0 +1,60 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <format>
+#include <string>
+
+#include "CppLexer.hpp"
+
+
+namespace {
+    constexpr auto Tags = "[lexer]";
+
+
+    std::string makeSource(std::size_t size) {
+        // most of the input is inside of strings and comments, so that the chunks start in the middle of them
+        auto source = std::string();
+        for(int i = 0; source.size() < size; i++) {
+            source += std::format("value{} = compute(lhs, {}) >> 1.5; // not a \"string\" nor a /* comment\n", i, i % 1000);
+
+            source += "/*\n";
+            for(int line = 0; line < 150; line++) {
+                source += std::format("    line {} of a comment, with \"quotes\" and // slashes\n", line);
+            }
+            source += "*/\n";
+
+            // a string with no newlines for longer than the lexer looks for one to start a chunk after
+            source += "text = \"";
+            for(int part = 0; part < 500; part++) {
+                source += std::format("part {} // /* \\\" ", part);
+            }
+            source += "\";\n";
+        }
+        return source;
+    }
+
+
+    bool isSame(const TokenBuffer& lhs, const TokenBuffer& rhs) {
+        return std::ranges::equal(lhs.kinds(), rhs.kinds())
+            && std::ranges::equal(lhs.offsets(), rhs.offsets())
+            && std::ranges::equal(lhs.lengths(), rhs.lengths());
+    }
+}
+
+
+TEST_CASE("lexing in parallel produces the same tokens as lexing sequentially", Tags) {
+    const auto source = makeSource(std::size_t(1) << 20);
+
+    auto expected = TokenBuffer();
+    Lexer(source).lexAll(expected);
+    REQUIRE(std::ranges::count(expected.kinds(), TokenKinds::String) != 0);
+    REQUIRE(std::ranges::count(expected.kinds(), TokenKinds::BlockComment) != 0);
+
+    for(const auto threads : { 2u, 3u, 5u, 8u, 13u, 16u }) {
+        auto tokens = TokenBuffer();
+        Lexer(source).lexAllParallel(tokens, threads);
+
+        CAPTURE(threads);
+        CHECK(isSame(tokens, expected));
+    }
+}
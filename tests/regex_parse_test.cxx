@@ -46,12 +46,31 @@ TEST_CASE("parsing character sets with a single element", Tags) {
 }
 
 TEST_CASE("parsing character sets with multiple elements", Tags) {
-    CHECK(parseRegex("[ab]") == "('a' | 'b')");
-    CHECK(parseRegex("[abc]") == "(('a' | 'b') | 'c')");
+    CHECK(parseRegex("[ab]") == "[ab]");
+    CHECK(parseRegex("[abc]") == "[a-c]");
+    CHECK(parseRegex("[cba]") == "[a-c]");
 }
 
 TEST_CASE("parsing character sets with character ranges", Tags) {
-    CHECK(parseRegex("[-da-co-op]") == "(((('-' | 'd') | (('a' | 'b') | 'c')) | 'o') | 'p')");
+    CHECK(parseRegex("[-da-co-op]") == "[\\-a-dop]");
+}
+
+TEST_CASE("parsing character sets with characters outside of the ASCII range", Tags) {
+    CHECK(parseRegex("[\\x80-\\xff]") == "[\\x80-\\xff]");
+}
+
+
+TEST_CASE("parsing negated character sets", Tags) {
+    CHECK(parseRegex("[^a]") == "[^a]");
+    CHECK(parseRegex("[^a-z_]") == "[^_a-z]");
+}
+
+TEST_CASE("parsing negated character sets with all but a single element", Tags) {
+    CHECK(parseRegex("[^\\x00-`b-\\xff]") == "'a'");
+}
+
+TEST_CASE("parsing empty negated character sets", Tags) {
+    CHECK(parseRegex("[^]") == "[^]");
 }
 
 
@@ -60,15 +79,15 @@ TEST_CASE("parsing character ranges with a single element", Tags) {
 }
 
 TEST_CASE("parsing character ranges with no low or high bound", Tags) {
-    CHECK(parseRegex("[a-]") == "('a' | '-')");
-    CHECK(parseRegex("[-a]") == "('-' | 'a')");
-    CHECK(parseRegex("[--]") == "('-' | '-')");
-    CHECK(parseRegex("[a-a-b]") == "(('a' | '-') | 'b')");
+    CHECK(parseRegex("[a-]") == "[\\-a]");
+    CHECK(parseRegex("[-a]") == "[\\-a]");
+    CHECK(parseRegex("[--]") == "'-'");
+    CHECK(parseRegex("[a-a-b]") == "[\\-ab]");
 }
 
 TEST_CASE("parsing character ranges with multiple elements", Tags) {
-    CHECK(parseRegex("[a-b]") == "('a' | 'b')");
-    CHECK(parseRegex("[a-c]") == "(('a' | 'b') | 'c')");
+    CHECK(parseRegex("[a-b]") == "[ab]");
+    CHECK(parseRegex("[a-c]") == "[a-c]");
 }
 
 
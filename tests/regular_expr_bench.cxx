@@ -0,0 +1,97 @@
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <format>
+#include <string>
+
+import parsec.bnf;
+import parsec.regex;
+
+using namespace parsec;
+
+
+namespace {
+    constexpr auto Tags = "[.][benchmark][bnf]";
+
+    regex::NodePtr symbolAtom(int index) {
+        return regex::atom(std::format("s{}", index));
+    }
+
+
+    regex::NodePtr makeConcat(int size) {
+        auto expr = symbolAtom(0);
+        for(int i = 1; i < size; i++) {
+            expr = regex::concat(expr, symbolAtom(i));
+        }
+        return expr;
+    }
+
+
+    regex::NodePtr makeAltern(int size) {
+        auto expr = symbolAtom(0);
+        for(int i = 1; i < size; i++) {
+            expr = regex::altern(expr, symbolAtom(i));
+        }
+        return expr;
+    }
+
+
+    regex::NodePtr makeNestedClosure(int depth) {
+        auto expr = symbolAtom(0);
+        for(int i = 1; i < depth; i++) {
+            expr = regex::starClosure(regex::concat(expr, regex::optional(symbolAtom(i))));
+        }
+        return expr;
+    }
+
+
+    regex::NodePtr makeRuleBody(int alternatives) {
+        // mimics a rule listing many alternative sequences with optional and repeated parts
+        auto expr = regex::NodePtr();
+        for(int i = 0; i < alternatives; i++) {
+            auto seq = regex::concat(
+                regex::concat(symbolAtom(3 * i), regex::optional(symbolAtom(3 * i + 1))),
+                regex::starClosure(symbolAtom(3 * i + 2))
+            );
+            expr = expr ? regex::altern(expr, seq) : seq;
+        }
+        return regex::plusClosure(expr);
+    }
+}
+
+
+TEST_CASE("computing positions of long concatenations", Tags) {
+    for(const auto size : { 100, 1000, 4000 }) {
+        const auto expr = makeConcat(size);
+        BENCHMARK(std::format("concatenation of {} atoms", size)) {
+            return bnf::RegularExpr(expr);
+        };
+    }
+}
+
+TEST_CASE("computing positions of long alternations", Tags) {
+    for(const auto size : { 100, 1000, 4000 }) {
+        const auto expr = makeAltern(size);
+        BENCHMARK(std::format("alternation of {} atoms", size)) {
+            return bnf::RegularExpr(expr);
+        };
+    }
+}
+
+TEST_CASE("computing positions of nested closures", Tags) {
+    for(const auto depth : { 50, 100, 200 }) {
+        const auto expr = makeNestedClosure(depth);
+        BENCHMARK(std::format("closures nested {} levels deep", depth)) {
+            return bnf::RegularExpr(expr);
+        };
+    }
+}
+
+TEST_CASE("computing positions of large rule bodies", Tags) {
+    for(const auto alternatives : { 30, 100, 300 }) {
+        const auto expr = makeRuleBody(alternatives);
+        BENCHMARK(std::format("rule body with {} alternatives", alternatives)) {
+            return bnf::RegularExpr(expr);
+        };
+    }
+}
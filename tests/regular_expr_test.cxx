@@ -0,0 +1,88 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <span>
+#include <vector>
+
+import parsec.bnf;
+
+using namespace parsec::bnf;
+
+
+namespace {
+    constexpr auto Tags = "[bnf][regex]";
+
+    std::vector<int> toVector(std::span<const int> positions) {
+        return { positions.begin(), positions.end() };
+    }
+}
+
+
+TEST_CASE("computing positions of an empty expression", Tags) {
+    const auto regex = RegularExpr("");
+
+    CHECK(toVector(regex.firstPos()) == std::vector{ 0 });
+    CHECK(regex.isEndPos(0));
+    CHECK(regex.followPos(0).empty());
+}
+
+TEST_CASE("computing positions of a concatenation", Tags) {
+    const auto regex = RegularExpr("ab");
+
+    CHECK(toVector(regex.firstPos()) == std::vector{ 0 });
+    CHECK(toVector(regex.followPos(0)) == std::vector{ 1 });
+    CHECK(toVector(regex.followPos(1)) == std::vector{ 2 });
+    CHECK(regex.isEndPos(2));
+}
+
+TEST_CASE("computing positions of closures", Tags) {
+    // the classic example of (a|b)*abb
+    const auto regex = RegularExpr("(a|b)*abb");
+
+    CHECK(toVector(regex.firstPos()) == std::vector{ 0, 1, 2 });
+    CHECK(toVector(regex.followPos(0)) == std::vector{ 0, 1, 2 });
+    CHECK(toVector(regex.followPos(1)) == std::vector{ 0, 1, 2 });
+    CHECK(toVector(regex.followPos(2)) == std::vector{ 3 });
+    CHECK(toVector(regex.followPos(3)) == std::vector{ 4 });
+    CHECK(toVector(regex.followPos(4)) == std::vector{ 5 });
+    CHECK(regex.isEndPos(5));
+}
+
+TEST_CASE("computing positions of expressions with empty subexpressions", Tags) {
+    const auto regex = RegularExpr("()a*");
+
+    CHECK(toVector(regex.firstPos()) == std::vector{ 0, 1 });
+    CHECK(toVector(regex.followPos(0)) == std::vector{ 0, 1 });
+    CHECK(regex.isEndPos(1));
+}
+
+TEST_CASE("computing positions of character sets", Tags) {
+    const auto regex = RegularExpr("[a-z]+");
+
+    CHECK(toVector(regex.firstPos()) == std::vector{ 0 });
+    CHECK(toVector(regex.followPos(0)) == std::vector{ 0, 1 });
+    REQUIRE(regex.charSetAt(0));
+    CHECK(regex.charSetAt(0)->count() == 26);
+}
+
+TEST_CASE("extracting the literal string of an expression", Tags) {
+    CHECK(RegularExpr("while").literal() == "while");
+    CHECK(RegularExpr("a(bc)").literal() == "abc");
+    CHECK(RegularExpr("").literal() == "");
+
+    CHECK_FALSE(RegularExpr("ab?").literal());
+    CHECK_FALSE(RegularExpr("a|b").literal());
+    CHECK_FALSE(RegularExpr("[ab]").literal());
+}
+
+TEST_CASE("matching strings against an expression", Tags) {
+    const auto regex = RegularExpr("[a-z_][a-z0-9_]*");
+
+    CHECK(regex.matches("while"));
+    CHECK(regex.matches("x1"));
+    CHECK_FALSE(regex.matches(""));
+    CHECK_FALSE(regex.matches("1x"));
+    CHECK_FALSE(regex.matches("a+"));
+
+    CHECK(RegularExpr("ab*").matches("abbb"));
+    CHECK_FALSE(RegularExpr("ab*").matches("ba"));
+}
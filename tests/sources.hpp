@@ -0,0 +1,19 @@
+#pragma once
+
+#include <format>
+#include <string>
+
+
+/**
+ * @brief Make an input for the C++ lexer that mimics ordinary source code, with the occasional long line.
+ */
+inline std::string makeCppSource(std::size_t size) {
+    auto source = std::string();
+    for(int i = 0; source.size() < size; i++) {
+        source += std::format("    auto value{} = compute(lhs_{} + {}, rhs >> {}) * 1.5;\n", i, i % 97, i % 1000, i % 7);
+        if(i % 100 == 0) {
+            source += "    if(first && second || !third) { result[index] <<= shift; } else { result[index] ^= mask; }\n";
+        }
+    }
+    return source;
+}
@@ -0,0 +1,80 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <sstream>
+#include <string>
+
+import parsec;
+import parsec.bnf;
+
+using namespace parsec::bnf;
+
+
+namespace {
+    constexpr auto Tags = "[bnf][symbol]";
+}
+
+
+TEST_CASE("symbols with equal names share the same identifier", Tags) {
+    const auto lhs = Symbol("abc");
+    const auto rhs = Symbol(std::string("ab") + 'c');
+
+    CHECK(lhs == rhs);
+    CHECK(lhs.id() == rhs.id());
+    CHECK(&lhs.text() == &rhs.text());
+}
+
+TEST_CASE("symbols with different names have different identifiers", Tags) {
+    CHECK(Symbol("abc") != Symbol("abd"));
+    CHECK(Symbol("abc").id() != Symbol("abd").id());
+}
+
+TEST_CASE("empty symbols have the identifier 0", Tags) {
+    CHECK(Symbol().id() == 0);
+    CHECK(Symbol("").id() == 0);
+    CHECK(Symbol().isEmpty());
+    CHECK_FALSE(Symbol("a").isEmpty());
+}
+
+TEST_CASE("symbols are ordered by their names", Tags) {
+    // create the symbols in the reverse order to make sure identifiers do not affect the ordering
+    const auto b = Symbol("symbol-order-b");
+    const auto a = Symbol("symbol-order-a");
+
+    CHECK(a < b);
+    CHECK(b > a);
+}
+
+TEST_CASE("symbols are interned into the table of the current scope", Tags) {
+    const auto outer = Symbol("symbol-scoped");
+
+    SymbolTable table(false);
+    {
+        const SymbolTable::Scope scope(&table);
+        const auto inner = Symbol("symbol-scoped");
+
+        CHECK(SymbolTable::current() == &table);
+        CHECK(table.nameCount() == 1);
+        CHECK(&inner.text() != &outer.text());
+        CHECK(Symbol(std::string("symbol-") + "scoped") == inner);
+        CHECK(Symbol().isEmpty());
+    }
+
+    CHECK(SymbolTable::current() != &table);
+    CHECK(Symbol("symbol-scoped") == outer);
+    CHECK(table.nameCount() == 1);
+}
+
+TEST_CASE("compilation does not add to the process-wide symbol table", Tags) {
+    auto input = std::istringstream("tokens { number = \"[0-9]+\"; plus = '+'; } rules { sum = number ( plus number )*; }");
+    auto output = std::ostringstream();
+
+    const auto nameCount = SymbolTable::current()->nameCount();
+
+    parsec::Compiler compiler;
+    compiler.setInputSource(&input);
+    compiler.setOutputSink(&output);
+    compiler.compile();
+
+    CHECK_FALSE(output.view().empty());
+    CHECK(SymbolTable::current()->nameCount() == nameCount);
+}